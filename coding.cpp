@@ -12,6 +12,8 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <random>
+#include <algorithm>
+#include <mapped_file.hpp>
 
 #include <boneh.hpp>
 #include <li.hpp>
@@ -24,28 +26,11 @@ using namespace mcl::bls12;
 typedef Chang sigScheme;
 typedef G1 sigType;
 
-std::vector<uint8_t> readFile(const char *fileName)
-{
-    // open the file:
-    std::streampos fileSize;
-    std::ifstream file(fileName, std::ios::binary);
-
-    // get its size:
-    file.seekg(0, std::ios::end);
-    fileSize = file.tellg();
-    file.seekg(0, std::ios::beg);
-
-    // read the data:
-    std::vector<uint8_t> fileData(fileSize);
-    file.read((char *)&fileData[0], fileSize);
-    return fileData;
-}
-
 int main(int argc, char **argv)
 {
     srand(unsigned(time(NULL)));
     initPairing();
-    std::vector<uint8_t> fileData = readFile("../logo.png");
+    MappedFile file = MappedFile::OpenRead("../logo.png");
 
     if (argc < 2)
     {
@@ -53,7 +38,7 @@ int main(int argc, char **argv)
         return 1;
     }
     int pieceCount = strtol(argv[1], NULL, 10);
-    int pieceSize = ceil((float)fileData.size() / (float)pieceCount);
+    int pieceSize = PieceSizeFor(file.Size(), pieceCount);
     assert(pieceSize >= pieceCount);
     int codedPieceCount = pieceCount * 2;
     int droppedPieceCount = pieceCount;
@@ -65,7 +50,7 @@ int main(int argc, char **argv)
     // Fr fid;
     // fid.setRand();
     // sigScheme scheme(pieceCount, pieceSize, fid);
-    FullRLNCEncoder<sigScheme, sigType> encoder(fileData, pieceCount, scheme, true);
+    FullRLNCEncoder<sigScheme, sigType> encoder(file.Data(), file.Size(), pieceCount, scheme, true);
 
     std::vector<CodedPiece<sigType>> codedPieces(codedPieceCount);
     for (int i = 0; i < codedPieceCount; i++)
@@ -93,9 +78,8 @@ int main(int argc, char **argv)
         decoder.addPiece(droppedPiecesAgain[i]);
     }
 
-    std::vector<uint8_t>
-        decodedData = decoder.getData();
-    if (decodedData != fileData)
+    std::vector<uint8_t> decodedData = decoder.getData(file.Size());
+    if (!std::equal(decodedData.begin(), decodedData.end(), file.Data()))
     {
         std::cout << "[DECODER] ERROR Incorrect decoding!" << std::endl;
     }
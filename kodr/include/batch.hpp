@@ -0,0 +1,33 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include "data.hpp"
+
+#ifndef BATCH_HPP
+#define BATCH_HPP
+
+using namespace mcl::bls12;
+
+// Verifies all pieces with a single random linear combination. Since every
+// scheme is linearly homomorphic, the combined piece only verifies if (with
+// overwhelming probability) every piece in it does. A failing batch is split
+// in halves until the invalid pieces are isolated.
+template <typename T, typename S>
+std::vector<bool> BatchVerify(T &scheme, std::vector<CodedPiece<S>> &pieces);
+
+// Checks that the signature points of all pieces lie in the prime order
+// subgroup. Random subset sums of the batch are tested instead of every
+// point, a point outside the subgroup survives a round with probability at
+// most 1/2. Small batches and failing ones are checked point by point.
+template <typename S>
+std::vector<bool> CheckSubgroup(std::vector<CodedPiece<S>> &pieces);
+
+// Reads the pieces written back to back into buf, replacing the contents of
+// pieces. Their signature points are only checked to lie on the curve while
+// being read and then all at once by CheckSubgroup, whose result is returned.
+template <typename S>
+std::vector<bool> DeserializeBatch(std::vector<CodedPiece<S>> &pieces, const uint8_t *buf, size_t bufLen,
+                                   uint8_t schemeTag, int pieceCount);
+
+#endif
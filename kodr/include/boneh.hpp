@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include "data.hpp"
+#include "pairing.hpp"
+#include "point_cache.hpp"
+#include "msm.hpp"
 
 #ifndef BONEH_HPP
 #define BONEH_HPP
@@ -16,16 +19,24 @@ private:
     G2 h;
     Fr alpha;
     G2 u;
+    PrecomputedG2 hLines;
+    PrecomputedG2 uLines;
     std::vector<G1> generators;
+    FixedBaseMSM generatorTable;
     std::string id;
-    void AggregateHash(G1 &P, std::vector<Fr> &vec, std::vector<Fr> &codingVec);
+    PointCache indexPoints; // hashAndMapToG1(id || i)
+    void AggregateHash(G1 &P, Span<const Fr> vec, Span<const Fr> codingVec);
 
 public:
-    Boneh(int pieceSize, std::string fileName);
+    // identifies the scheme in the wire header of coded pieces
+    static const uint8_t WireTag = 1;
+    // tableBudget bytes are spent on fixed-base tables for the generators
+    Boneh(int pieceSize, std::string fileName, size_t tableBudget = 0);
     Boneh();
-    G1 Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
-    G1 Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs);
+    G1 Sign(Span<const Fr> vec, Span<const Fr> codingVec);
+    G1 Combine(std::vector<G1> &signs, Span<const Fr> coeffs);
     bool Verify(CodedPiece<G1> &encodedPiece);
+    std::vector<bool> VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces);
 };
 
 #endif
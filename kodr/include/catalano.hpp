@@ -3,7 +3,14 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
 #include "data.hpp"
+#include "pairing.hpp"
+#include "msm.hpp"
 
 #ifndef CAT_HPP
 #define CAT_HPP
@@ -16,6 +23,35 @@ typedef struct CatSignature
     Fr s;
 } CatSignature;
 
+// Offline part of a signature: a fresh s with h * s already computed.
+typedef struct CatRandomness
+{
+    Fr s;
+    G1 hs;
+} CatRandomness;
+
+// Pool of CatRandomness kept topped up by a background thread, so Sign
+// only pays for the message dependent multi-exponentiations.
+class CatRandomnessPool
+{
+    private:
+        G1 h;
+        int capacity;
+        std::deque<CatRandomness> ready;
+        std::mutex lock;
+        std::condition_variable refill;
+        bool stopping;
+        std::thread worker;
+
+        void run();
+
+    public:
+        CatRandomnessPool(G1 h, int capacity);
+        ~CatRandomnessPool();
+        CatRandomness Take();
+        int Size();
+};
+
 class Catalano
 {
     private:
@@ -27,18 +63,36 @@ class Catalano
         G2 bigZ;
         std::vector<G1> hVec;
         std::vector<G1> gVec;
+        FixedBaseMSM hTable;
+        FixedBaseMSM gTable;
+        PrecomputedG2 gPrimeLines;
+        PrecomputedG2 keyLines; // bigZ + gPrime * fid
 
         // secret key components
         Fr z;
+        Fr signExp; // 1 / (fid + z)
+
+        std::shared_ptr<CatRandomnessPool> pool;
 
-        G1 AggregateHash(Fr secret, std::vector<Fr> &vec, std::vector<Fr> &codingVec);
+        G1 MessageHash(Span<const Fr> vec, Span<const Fr> codingVec);
+        G1 AggregateHash(Fr secret, Span<const Fr> vec, Span<const Fr> codingVec);
 
     public:
-        Catalano(uint8_t numPieces, uint8_t pieceSize, Fr fileID);
+        // identifies the scheme in the wire header of coded pieces
+        static const uint8_t WireTag = 4;
+        // tableBudget bytes are spent on fixed-base tables for hVec and gVec
+        Catalano(uint8_t numPieces, uint8_t pieceSize, Fr fileID, size_t tableBudget = 0);
         Catalano();
-        CatSignature Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
-        CatSignature Combine(std::vector<CatSignature> &signs, std::vector<Fr> &coeffs);
+        CatSignature Sign(Span<const Fr> vec, Span<const Fr> codingVec);
+        CatSignature Combine(std::vector<CatSignature> &signs, Span<const Fr> coeffs);
         bool Verify(CodedPiece<CatSignature> &encodedPiece);
+        std::vector<bool> VerifyBatch(std::vector<CodedPiece<CatSignature>> &encodedPieces);
+
+        // Precompute (s, h * s) pairs in the background for online signing.
+        // Copies of this scheme share the pool.
+        void StartOfflinePool(int capacity);
+        void StopOfflinePool();
+        int OfflinePoolSize();
 };
 
 #endif
\ No newline at end of file
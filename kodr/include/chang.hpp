@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include "data.hpp"
+#include "pairing.hpp"
+#include "point_cache.hpp"
+#include "msm.hpp"
 
 #ifndef CHANG_HPP
 #define CHANG_HPP
@@ -16,17 +19,25 @@ private:
     G2 h;
     Fr alpha;
     G2 u;
+    PrecomputedG2 hLines;
+    PrecomputedG2 uLines;
     std::vector<G1> generators;
+    FixedBaseMSM generatorTable;
     std::string id;
-    void AggregateHash(G1 &P, std::vector<Fr> &vec, std::vector<Fr> &codingVec, bool encoding);
-    void Hash(G1 &out, std::string &id, uint8_t &index, bool encoding);
+    PointCache indexPoints; // Hash(id, i)
+    void AggregateHash(G1 &P, Span<const Fr> vec, Span<const Fr> codingVec);
+    void Hash(G1 &out, std::string &id, uint8_t index);
 
 public:
-    Chang(int pieceSize, std::string fileName);
+    // identifies the scheme in the wire header of coded pieces
+    static const uint8_t WireTag = 5;
+    // tableBudget bytes are spent on fixed-base tables for the generators
+    Chang(int pieceSize, std::string fileName, size_t tableBudget = 0);
     Chang();
-    G1 Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
-    G1 Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs);
+    G1 Sign(Span<const Fr> vec, Span<const Fr> codingVec);
+    G1 Combine(std::vector<G1> &signs, Span<const Fr> coeffs);
     bool Verify(CodedPiece<G1> &encodedPiece);
+    std::vector<bool> VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces);
 };
 
 #endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <cstdint>
+
+#ifndef COEFFICIENTS_HPP
+#define COEFFICIENTS_HPP
+
+using namespace mcl::bls12;
+
+// ChaCha20 keystream turned into field elements, 32 bytes per element with
+// the top bits masked off so no reduction is needed.
+class CoefficientGenerator
+{
+private:
+    uint32_t state[16];
+    uint8_t block[256];
+    int used;
+
+    void refill();
+
+public:
+    // seeded from the system entropy source
+    CoefficientGenerator();
+    CoefficientGenerator(uint64_t seed);
+
+    void Reseed();
+    void Seed(const uint8_t key[32]);
+    void Seed(uint64_t seed);
+
+    void Fill(Fr *out, int n);
+
+    // n values uniform in [0, 2^bits), 0 < bits <= 32
+    void FillShort(uint32_t *out, int n, int bits);
+};
+
+// Generator owned by the calling thread.
+CoefficientGenerator &LocalCoefficients();
+
+#endif
@@ -2,6 +2,7 @@
 
 #include <mcl/bls12_381.hpp>
 #include <vector>
+#include "span.hpp"
 
 #ifndef DATA_HPP
 #define DATA_HPP
@@ -10,19 +11,59 @@ using namespace mcl::bls12;
 
 std::vector<Fr> multiply(std::vector<Fr> piece1, std::vector<Fr> piece2, Fr by);
 
+void multiplyAdd(Span<Fr> acc, Span<const Fr> piece, const Fr &by);
+
+std::vector<int> nonZeroIndices(Span<const Fr> vec, int begin = 0);
+
+// Appends offset + i for every nonzero vec[i], reusing the capacity of out.
+void appendNonZeroIndices(std::vector<int> &out, Span<const Fr> vec, int offset = 0);
+
+// Binary wire format of a coded piece (all integers little endian):
+//   u8 version | u8 scheme tag | u16 flags | u32 pieceSize | u32 codingVectorSize
+//   pieceSize + codingVectorSize field elements | signature
+// Field elements and points are written with mcl's raw serializers.
+const uint8_t WIRE_VERSION = 1;
+const int WIRE_HEADER_LEN = 12;
+const int FR_BYTES = 32;
+const int G1_BYTES = 48;
+
+// Signatures are sent as compressed points unless WIRE_UNCOMPRESSED is set,
+// which doubles their size but saves the square root on decompression.
+const uint16_t WIRE_UNCOMPRESSED = 1;
+// Pieces whose coding vector was expanded from a seed send the 8 byte seed
+// in its place. Pieces without one fall back to the full vector.
+const uint16_t WIRE_SEEDED = 2;
+const uint16_t WIRE_KNOWN_FLAGS = WIRE_UNCOMPRESSED | WIRE_SEEDED;
+const int SEED_BYTES = 8;
+
+// The payload and the coding vector share one buffer, [payload | coding
+// vector], which piece() and codingVector() view.
 template <typename T>
 struct CodedPiece
 {
-    std::vector<Fr> piece;
-    std::vector<Fr> codingVector;
+    std::vector<Fr> buffer;
+    int pieceSize = 0;
     T signature;
+    // set when codingVector() == expandCodingVector(seed, ...)
+    bool seeded = false;
+    uint64_t seed = 0;
 
     CodedPiece(std::vector<Fr> p, std::vector<Fr> v, T s);
 
+    CodedPiece(std::vector<Fr> &&buffer, int pieceSize, T s);
+
     CodedPiece(std::vector<uint8_t> &bytes, const int &pieceSize, const int &codingVectorSize);
 
     CodedPiece();
 
+    Span<Fr> piece() { return Span<Fr>(buffer.data(), pieceSize); }
+
+    Span<Fr> codingVector() { return Span<Fr>(buffer.data() + pieceSize, buffer.size() - pieceSize); }
+
+    Span<const Fr> piece() const { return Span<const Fr>(buffer.data(), pieceSize); }
+
+    Span<const Fr> codingVector() const { return Span<const Fr>(buffer.data() + pieceSize, buffer.size() - pieceSize); }
+
     int dataLen();
 
     int fullLen();
@@ -30,17 +71,68 @@ struct CodedPiece
     std::vector<uint8_t> toBytes();
 
     std::vector<Fr> flatten();
+
+    size_t wireLen(uint16_t flags = 0);
+
+    // Writes the piece into buf and returns the number of bytes written.
+    size_t serialize(uint8_t *buf, size_t bufLen, uint8_t schemeTag, uint16_t flags = 0);
+
+    // Reads a piece written by serialize and returns the number of bytes read.
+    // Pieces whose coding vector length is not pieceCount are rejected before
+    // anything is allocated, as a seeded header could claim any length.
+    // Without checkOrder the signature point is only checked to lie on the
+    // curve and must go through CheckSubgroup (batch.hpp) before it is used.
+    size_t deserialize(const uint8_t *buf, size_t bufLen, uint8_t schemeTag, int pieceCount, bool checkOrder = true);
 };
 
+// With packing enabled every field element carries PACKED_BYTES bytes of
+// the file (little endian) instead of a single one.
+const int PACKED_BYTES = 31;
+
+void packElement(Fr &out, const uint8_t *bytes, int len);
+void unpackElement(uint8_t *out, const Fr &x);
+
+// Number of field elements per piece needed to split dataLen bytes into
+// pieceCount pieces.
+int PieceSizeFor(int dataLen, int pieceCount, bool packed = false);
+
 std::vector<Fr> generateCodingVector(int n);
+
+// Short coefficients are drawn from [0, 2^bits) with 0 < bits <= 32. Rows
+// are then combined with single word multiplications, at the price of a
+// higher chance that a coded piece is not innovative.
+std::vector<uint32_t> generateShortCoefficients(int n, int bits);
+
+// Indices of the nonzero entries of a random coding vector where every
+// entry is nonzero with probability density; never empty.
+std::vector<int> sparseSupport(int n, double density);
+std::vector<Fr> generateSparseCodingVector(int n, double density);
+std::vector<Fr> shortToField(const std::vector<uint32_t> &coeffs);
+void multiplyAddShort(Span<Fr> acc, Span<const Fr> piece, uint32_t by);
+
+// Upper bound on the probability that a random combination is not
+// innovative for a receiver still missing pieces; 0 bits means full width
+// coefficients.
+double NonInnovativeProbability(int coefficientBits);
+
+uint64_t generateSeed();
+std::vector<Fr> expandCodingVector(uint64_t seed, int n);
 std::vector<Fr> generateSystematicVector(int idx, int n);
 
 std::vector<std::vector<Fr>>
-OriginalPiecesWithCountAndSize(std::vector<uint8_t> data, int pieceCount, int pieceSize);
+OriginalPiecesWithCountAndSize(const std::vector<uint8_t> &data, int pieceCount, int pieceSize, bool packed = false);
+
+std::vector<std::vector<Fr>> OriginalPiecesFromDataAndPieceCount(const std::vector<uint8_t> &data, int pieceCount, bool packed = false);
+
+std::vector<std::vector<Fr>> OriginalPiecesFromDataAndPieceSize(const std::vector<uint8_t> &data, int pieceSize, bool packed = false);
+
+// Same as above, reading len bytes in place (e.g. from a MappedFile).
+std::vector<std::vector<Fr>>
+OriginalPiecesWithCountAndSize(const uint8_t *data, size_t len, int pieceCount, int pieceSize, bool packed = false);
 
-std::vector<std::vector<Fr>> OriginalPiecesFromDataAndPieceCount(std::vector<uint8_t> data, int pieceCount);
+std::vector<std::vector<Fr>> OriginalPiecesFromDataAndPieceCount(const uint8_t *data, size_t len, int pieceCount, bool packed = false);
 
-std::vector<std::vector<Fr>> OriginalPiecesFromDataAndPieceSize(std::vector<uint8_t> data, int pieceSize);
+std::vector<std::vector<Fr>> OriginalPiecesFromDataAndPieceSize(const uint8_t *data, size_t len, int pieceSize, bool packed = false);
 
 std::string RandomString(int length);
 
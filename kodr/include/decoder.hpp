@@ -15,11 +15,17 @@ template <typename T, typename S>
 class FullRLNCDecoder
 {
 public:
+    // received counts the pieces taken before decoding finished, both the
+    // verified innovative ones and the redundant ones, which are dropped
+    // without verifying their signature
     int expected, useful, received;
     DecoderState<S> state;
     T sig;
+    bool packed;
 
-    FullRLNCDecoder(int pieceCount, T sig);
+    // packed must match the encoder's packing mode; sparse selects the
+    // elimination for sparse coding vectors (see DecoderState)
+    FullRLNCDecoder(int pieceCount, T sig, bool packed = false, bool sparse = false);
 
     FullRLNCDecoder();
 
@@ -29,11 +35,22 @@ public:
 
     int Required();
 
-    void addPiece(CodedPiece<S> piece);
+    // The piece is only read; its rows are copied into the decoder state.
+    void addPiece(CodedPiece<S> &piece);
+
+    void addPiece(CodedPiece<S> &&piece);
 
     std::vector<Fr> getPiece(int i);
 
+    // Strips the zero padding, along with any zero bytes the data ends with.
     std::vector<uint8_t> getData();
+
+    // The first length bytes of the decoded data, for callers that know it.
+    std::vector<uint8_t> getData(size_t length);
+
+    // Writes the first length bytes of the decoded data to out, every piece
+    // at its offset in the original data (e.g. into a MappedFile).
+    void writeData(uint8_t *out, size_t length);
 };
 
 #endif
\ No newline at end of file
@@ -17,18 +17,30 @@ public:
     Matrix coeffs;
     Matrix coded;
 
+    // Only innovative pieces are kept, one row each; pivots[c] is the row
+    // whose leading column is c, or -1. Dense mode keeps coeffs in reduced
+    // row echelon form: each new row is reduced against the pivots and then
+    // cleared from the earlier rows, O(k * (k + pieceSize)) per piece.
+    // Sparse mode keeps one SparseRow per piece instead and leaves coeffs
+    // unused; its back substitution only runs once the rank is full.
+    bool sparse;
+    std::vector<SparseRow> sparseCoeffs;
+    std::vector<int> pivots;
+    std::vector<Fr> probe; // scratch row of IsInnovative
+
     DecoderState(Matrix cfs, Matrix pieces);
 
-    DecoderState(int p);
+    DecoderState(int p, bool sparse = false);
 
     DecoderState();
 
-    void clean_forward();
+    void dense_add(Span<const Fr> codingVector, Span<const Fr> piece);
 
-    void clean_backward();
+    void sparse_forward(SparseRow &row, int target);
 
-    void remove_zero_rows();
+    void sparse_backward();
 
+    // Finishes the sparse back substitution; the dense state needs nothing.
     void Rref();
 
     int Rank();
@@ -37,7 +49,13 @@ public:
 
     Matrix CodedMatrix();
 
-    void AddPiece(CodedPiece<S> a);
+    void AddPiece(CodedPiece<S> &a);
+
+    // Whether a piece with this coding vector would raise the rank. Only
+    // field arithmetic on the coding vector, so it is cheap next to verifying
+    // a signature. Vectors of the wrong length count as innovative; AddPiece
+    // throws on them in both modes.
+    bool IsInnovative(Span<const Fr> codingVector);
 
     std::vector<Fr> GetPiece(int idx);
 };
@@ -4,8 +4,10 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <string>
+#include <memory>
 #include "boneh.hpp"
 #include "li.hpp"
+#include "thread_pool.hpp"
 
 #ifndef ENCODER_HPP
 #define ENCODER_HPP
@@ -13,11 +15,19 @@
 template <typename T, typename S>
 class FullRLNCEncoder
 {
+private:
+    void drawCodingVector(std::vector<Fr> &codingVec, std::vector<uint32_t> &words, bool &seeded, uint64_t &seed);
+
 public:
     std::vector<std::vector<Fr>> pieces;
     T sig;
     bool useSystematic;
     int pieceIndex;
+    bool deriveSignatures;
+    std::vector<S> baseSignatures;
+    bool seedCodingVectors;
+    int coefficientBits;
+    double density;
 
     int PieceCount();
 
@@ -29,11 +39,43 @@ public:
 
     CodedPiece<S> getCodedPiece();
 
+    // Produces n pieces at once: the payloads are one blocked matrix product
+    // of an n x PieceCount() coefficient block with the original pieces, and
+    // the signatures are computed concurrently on pool (shared pool if null).
+    std::vector<CodedPiece<S>> getCodedPieces(int n, std::shared_ptr<ThreadPool> pool = nullptr);
+
     void setPieces(std::vector<std::vector<Fr>> pieces);
 
+    // When enabled the original pieces are signed once per generation and
+    // every coded piece's signature is derived from them with Combine, so
+    // its cost no longer depends on the piece size.
+    void setDeriveSignatures(bool derive);
+
+    // When enabled random coding vectors are expanded from a seed that is
+    // kept on the piece, so it can be sent in place of the vector.
+    void setSeedCodingVectors(bool seeded);
+
+    // Draws random coefficients with bits bits (0 restores full width), see
+    // generateShortCoefficients. Short pieces are never seeded.
+    void setShortCoefficients(int bits);
+
+    // Fraction of nonzero coefficients in random coding vectors, see
+    // sparseSupport. Sparse pieces are sent with their full vector.
+    void setDensity(double density);
+
+    // For sparse vectors this is the chance of missing the one original
+    // piece a receiver still lacks.
+    double NonInnovativeProbability();
+
+    void signOriginals(std::shared_ptr<ThreadPool> pool = nullptr);
+
     FullRLNCEncoder(std::vector<std::vector<Fr>> pieces, T sig, bool generateSystematic);
 
-    FullRLNCEncoder(std::vector<uint8_t> data, int pieceCountOrSize, T sig, bool generateSystematic, bool fromSize = false);
+    // packed stores PACKED_BYTES bytes of data per field element
+    FullRLNCEncoder(const std::vector<uint8_t> &data, int pieceCountOrSize, T sig, bool generateSystematic, bool fromSize = false, bool packed = false);
+
+    // reads len bytes in place, e.g. from a MappedFile
+    FullRLNCEncoder(const uint8_t *data, size_t len, int pieceCountOrSize, T sig, bool generateSystematic, bool fromSize = false, bool packed = false);
 
     FullRLNCEncoder();
 };
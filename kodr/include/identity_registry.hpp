@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <string>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include "data.hpp"
+
+#ifndef IDENTITY_REGISTRY_HPP
+#define IDENTITY_REGISTRY_HPP
+
+using namespace mcl::bls12;
+
+// Verifier-side cache of per-sender state for the identity based schemes
+// (Li, Zhang). Each known node keeps its derived G2 key, pairing lines and
+// position tables, so verifying pieces from it skips all identity
+// derivation. Least recently used senders are evicted once the entries
+// exceed the memory budget. Keys arrive unauthenticated, so a cached sender
+// is only replaced by one under a new key once a piece under that key has
+// verified.
+template <typename T>
+class IdentityRegistry
+{
+private:
+    struct Entry
+    {
+        std::shared_ptr<T> verifier;
+        size_t footprint;
+        std::list<std::string>::iterator position;
+    };
+
+    T authority;
+    size_t memoryBudget;
+    size_t memoryUsed;
+    std::list<std::string> recency; // most recently used first
+    std::unordered_map<std::string, Entry> entries;
+    std::mutex lock;
+
+    void update(const std::string &nodeID);
+    void evict();
+    void adopt(const std::string &nodeID, std::shared_ptr<T> verifier);
+    bool cachedKey(const std::string &nodeID, G2 &key);
+
+public:
+    IdentityRegistry(T authority, size_t memoryBudget);
+
+    // Cached verifier for the node; a key other than the cached one gets a
+    // temporary verifier that leaves the cache untouched.
+    std::shared_ptr<T> Sender(const std::string &nodeID, const G2 &nodeKey);
+
+    bool Verify(const std::string &nodeID, const G2 &nodeKey, CodedPiece<G1> &piece);
+
+    std::vector<bool> VerifyBatch(const std::string &nodeID, const G2 &nodeKey, std::vector<CodedPiece<G1>> &pieces);
+
+    // Groups pieces by sender and checks every group with one batch.
+    std::vector<bool> VerifyGrouped(std::vector<std::string> &nodeIDs, std::vector<G2> &nodeKeys, std::vector<CodedPiece<G1>> &pieces);
+
+    int Size();
+
+    size_t MemoryUsed();
+};
+
+#endif
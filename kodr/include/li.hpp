@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 #include "data.hpp"
+#include "pairing.hpp"
+#include "point_cache.hpp"
 
 #ifndef LI_HPP
 #define LI_HPP
@@ -19,6 +21,10 @@ class Li
         G2 mpk;
         std::vector<uint8_t> fileIDBytes;
         std::vector<uint8_t> nodeIDBytes;
+        PrecomputedG2 hLines;
+        PointCache indexPoints; // h1(fileID, i)
+        ScalarCache positionScalars; // h2(nodeID, j, fileID, big_r)
+        PrecomputedG2 keyLines; // big_r + mpk * h0(nodeID, big_r)
         
         // secret key components
         Fr sk;
@@ -28,14 +34,25 @@ class Li
         G1 h1(std::vector<uint8_t> &inputBytes, uint8_t &index);
         Fr h2(std::vector<uint8_t> &inputBytes, uint8_t &index, std::vector<uint8_t> &extraBytes, G2 &element);
         bool verifyPrivateKey();
-        G1 AggregateHash(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
+        G1 AggregateHash(Span<const Fr> vec, Span<const Fr> codingVec);
 
     public:
+        // identifies the scheme in the wire header of coded pieces
+        static const uint8_t WireTag = 2;
         Li(std::string nodeID, std::string fileName);
         Li();
-        G1 Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
-        G1 Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs);
+        G1 Sign(Span<const Fr> vec, Span<const Fr> codingVec);
+        G1 Combine(std::vector<G1> &signs, Span<const Fr> coeffs);
         bool Verify(CodedPiece<G1> &encodedPiece);
+        std::vector<bool> VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces);
+
+        // Signing key for another node under the same master key.
+        Li Extract(std::string nodeID);
+        // Verifier for pieces signed by another node under the same master
+        // key, identified by its ID and the big_r it publishes.
+        Li ForSender(std::string nodeID, G2 nodeKey);
+        G2 NodeKey();
+        size_t MemoryFootprint();
 };
 
 #endif
\ No newline at end of file
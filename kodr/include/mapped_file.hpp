@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+// A file mapped into memory, read only or as a writable output of a fixed
+// size. The mapping is released when the object is destroyed.
+class MappedFile
+{
+private:
+    int fd;
+    uint8_t *data;
+    size_t size;
+
+    MappedFile(int fd, size_t size, bool writable);
+
+public:
+    static MappedFile OpenRead(const std::string &path);
+
+    // Creates (or truncates) path to size bytes and maps it for writing.
+    static MappedFile Create(const std::string &path, size_t size);
+
+    MappedFile();
+    MappedFile(MappedFile &&other);
+    MappedFile &operator=(MappedFile &&other);
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    uint8_t *Data();
+    size_t Size();
+
+    // Flushes written pages to the file.
+    void Sync();
+
+    void Close();
+};
+
+#endif
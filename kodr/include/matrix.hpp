@@ -3,15 +3,57 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <stdexcept>
+#include <cstdlib>
+#include <new>
+#include "span.hpp"
 
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
 using namespace mcl::bls12;
 
+// Allocator handing out storage aligned to ALIGNMENT bytes, so every row
+// starts on a cache line when the row size allows it.
+const size_t ALIGNMENT = 64;
+
+template <typename T>
+struct AlignedAllocator
+{
+    typedef T value_type;
+
+    AlignedAllocator() {}
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U> &) {}
+
+    T *allocate(size_t n)
+    {
+        size_t bytes = (n * sizeof(T) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        void *p = std::aligned_alloc(ALIGNMENT, bytes);
+        if (!p)
+        {
+            throw std::bad_alloc();
+        }
+        return (T *)p;
+    }
+
+    void deallocate(T *p, size_t) { std::free(p); }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U> &) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U> &) const { return false; }
+};
+
+// Row-major matrix in one flat buffer. Logical row i lives at physical row
+// order[i], so swapping or removing rows only moves indices; slots of
+// removed rows are reused by later appends.
 typedef struct Matrix
 {
-    std::vector<std::vector<Fr>> data;
+    std::vector<Fr, AlignedAllocator<Fr>> storage;
+    std::vector<int> order;
+    std::vector<int> freeRows;
     int rows;
     int cols;
 
@@ -21,9 +63,49 @@ typedef struct Matrix
 
     Matrix(int row, int cols);
 
+    Fr *Row(int i);
+
+    const Fr *Row(int i) const;
+
+    Fr &At(int i, int j);
+
+    std::vector<Fr> GetRow(int i) const;
+
+    void AppendRow(Span<const Fr> row);
+
+    void SwapRows(int a, int b);
+
+    void RemoveRow(int i);
+
+    // row dst -= by * row src, over columns [from, cols)
+    void SubtractRow(int dst, int src, const Fr &by, int from = 0);
+
+    // row i *= by, over columns [from, cols)
+    void ScaleRow(int i, const Fr &by, int from = 0);
+
     bool Cmp(Matrix &other);
 
     Matrix Multiply(Matrix other);
 } Matrix;
 
+// Row that only stores its nonzero entries, by increasing column.
+typedef struct SparseRow
+{
+    std::vector<int> cols;
+    std::vector<Fr> values;
+
+    SparseRow(Span<const Fr> dense);
+
+    SparseRow();
+
+    bool Empty();
+
+    void Scale(const Fr &by);
+
+    // this -= by * other, touching only the nonzero entries of both rows
+    void SubtractMultiple(const SparseRow &other, const Fr &by);
+
+    std::vector<Fr> Dense(int n);
+} SparseRow;
+
 #endif
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <memory>
+#include "thread_pool.hpp"
+
+#ifndef MSM_HPP
+#define MSM_HPP
+
+using namespace mcl::bls12;
+
+// Products with at least threshold terms are split into point ranges that
+// run on pool (the shared pool when null), one range per thread.
+void SetParallelMSM(std::shared_ptr<ThreadPool> pool, int threshold);
+
+// out = sum_{i < n} scalars[i] * points[i], on several threads when n is
+// above the parallel threshold. points may be normalized in place. When all
+// scalars fit in 32 bits (short coefficient mode) a bucket method without
+// full width doublings is used.
+void MultiExp(G1 &out, G1 *points, const Fr *scalars, int n);
+
+// Terms of a multi-scalar multiplication. Terms with a zero scalar are
+// dropped, so sparse payloads and coding vectors (e.g. systematic pieces)
+// only pay for their nonzero entries.
+typedef struct MSMTerms
+{
+    std::vector<G1> points;
+    std::vector<Fr> scalars;
+
+    void Add(const G1 &P, const Fr &x);
+
+    void AddNonZero(const G1 *P, const Fr *x, int n);
+
+    // drops all terms but keeps the capacity
+    void Clear();
+
+    void Eval(G1 &out);
+} MSMTerms;
+
+// Multi-scalar multiplication over bases that never change. For every base
+// P the points 2^(window*j) * P are precomputed, which turns each product
+// into a single pass of window-bit buckets with no doublings. The window is
+// the cheapest one whose table fits in memoryBudget; when none fits the
+// engine stays disabled and callers fall back to G1::mulVec.
+class FixedBaseMSM
+{
+private:
+    int window;
+    int windows;
+    int bases;
+    std::shared_ptr<const std::vector<G1>> table; // table[i * windows + j] = 2^(window * j) * P_i
+
+    void mulRange(G1 &out, const Fr *scalars, int begin, int end);
+
+public:
+    FixedBaseMSM(std::vector<G1> &points, size_t memoryBudget);
+    FixedBaseMSM();
+
+    bool Enabled();
+    size_t MemoryFootprint();
+
+    // out = sum_{i < n} scalars[i] * P_i
+    void MulVec(G1 &out, const Fr *scalars, int n);
+};
+
+#endif
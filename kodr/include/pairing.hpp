@@ -0,0 +1,27 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+
+#ifndef PAIRING_HPP
+#define PAIRING_HPP
+
+using namespace mcl::bls12;
+
+// A G2 point that is fixed for the lifetime of a scheme, together with the
+// Miller loop lines computed for it once up front.
+typedef struct PrecomputedG2
+{
+    G2 point;
+    std::vector<Fp6> lines;
+
+    PrecomputedG2(const G2 &Q);
+
+    PrecomputedG2();
+} PrecomputedG2;
+
+// Checks e(P1, Q1) == e(P2, Q2) as e(P1, Q1) * e(-P2, Q2) == 1, sharing both
+// Miller loops and a single final exponentiation.
+bool PairingsEqual(const G1 &P1, const PrecomputedG2 &Q1, const G1 &P2, const PrecomputedG2 &Q2);
+
+#endif
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <functional>
+
+#ifndef POINT_CACHE_HPP
+#define POINT_CACHE_HPP
+
+using namespace mcl::bls12;
+
+// Table of values that only depend on their index, such as the hashed
+// coding-vector points of a file. Entries are derived lazily the first time
+// an index is requested and reused afterwards. Copies share the table, and
+// a table handed out stays valid while the cache grows in another thread:
+// the table grows in place while nobody else holds it and is only copied
+// when a reader still does. Capacity doubles, so filling n entries one
+// by one costs O(n) copies.
+// Only the requested entries of a returned table are guaranteed to be set.
+template <typename T>
+class IndexCache
+{
+private:
+    struct State
+    {
+        std::mutex lock;
+        std::shared_ptr<std::vector<T>> values;
+        std::vector<bool> ready;
+        int prefix; // entries [0, prefix) are all ready
+    };
+    std::shared_ptr<State> state;
+
+public:
+    IndexCache();
+    // Entries [0, n).
+    std::shared_ptr<const std::vector<T>> Get(int n, const std::function<void(T &, int)> &derive);
+    // Only the listed entries, for sparse vectors.
+    std::shared_ptr<const std::vector<T>> GetSome(const std::vector<int> &indices, const std::function<void(T &, int)> &derive);
+    void Clear();
+    int Size();
+};
+
+typedef IndexCache<G1> PointCache;
+typedef IndexCache<Fr> ScalarCache;
+
+#endif
@@ -2,6 +2,7 @@
 
 #include "data.hpp"
 #include "matrix.hpp"
+#include "decoder_state.hpp"
 #include <mcl/bls12_381.hpp>
 #include "vector"
 #include "boneh.hpp"
@@ -17,6 +18,11 @@ public:
     std::vector<CodedPiece<S>> pieces;
     T sig;
     int pieceCount;
+    int coefficientBits;
+    double density;
+    bool skipRedundant;
+    // coding vectors of the held pieces, reduced, when skipRedundant is set
+    DecoderState<S> basis;
 
     FullRLNCRecoder(std::vector<CodedPiece<S>> ps, T sig);
 
@@ -24,11 +30,30 @@ public:
 
     FullRLNCRecoder();
 
-    void addPiece(CodedPiece<S> piece);
+    // Pieces are copied in, or taken over when passed as temporaries.
+    void addPiece(CodedPiece<S> &piece);
+
+    void addPiece(CodedPiece<S> &&piece);
 
     void clear();
 
     CodedPiece<S> getCodedPiece();
+
+    // Recombines with bits bit coefficients (0 restores full width).
+    void setShortCoefficients(int bits);
+
+    // Fraction of the held pieces mixed into each recoded piece.
+    void setDensity(double density);
+
+    double NonInnovativeProbability();
+
+    // Drops pieces whose coding vector is a combination of the held ones
+    // before verifying them. They would add nothing to the recoded pieces.
+    void setSkipRedundant(bool skip);
+
+private:
+    // checks a piece before it is added, and records its coding vector
+    bool accept(CodedPiece<S> &piece);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <type_traits>
+
+#ifndef SPAN_HPP
+#define SPAN_HPP
+
+// Non-owning view of len contiguous elements, e.g. one part of a coded
+// piece's buffer. Vectors convert to spans implicitly.
+template <typename T>
+struct Span
+{
+    typedef typename std::remove_const<T>::type value_type;
+
+    T *ptr;
+    size_t len;
+
+    Span() : ptr(nullptr), len(0) {}
+
+    Span(T *ptr, size_t len) : ptr(ptr), len(len) {}
+
+    template <typename A>
+    Span(std::vector<value_type, A> &v) : ptr(v.data()), len(v.size()) {}
+
+    template <typename A, typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+    Span(const std::vector<value_type, A> &v) : ptr(v.data()), len(v.size()) {}
+
+    template <typename U, typename = typename std::enable_if<std::is_convertible<U *, T *>::value>::type>
+    Span(const Span<U> &other) : ptr(other.ptr), len(other.len) {}
+
+    size_t size() const { return len; }
+
+    bool empty() const { return len == 0; }
+
+    T *data() const { return ptr; }
+
+    T *begin() const { return ptr; }
+
+    T *end() const { return ptr + len; }
+
+    T &operator[](size_t i) const { return ptr[i]; }
+
+    Span<T> sub(size_t offset, size_t n) const { return Span<T>(ptr + offset, n); }
+
+    std::vector<value_type> ToVector() const { return std::vector<value_type>(ptr, ptr + len); }
+};
+
+#endif
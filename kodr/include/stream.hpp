@@ -0,0 +1,95 @@
+#pragma once
+
+#include "data.hpp"
+#include "encoder.hpp"
+#include "decoder.hpp"
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <map>
+#include <istream>
+#include <ostream>
+#include <functional>
+#include <cstdint>
+
+#ifndef STREAM_HPP
+#define STREAM_HPP
+
+// A stream is cut into generations of generationBytes bytes (the last one may
+// be shorter), each coded on its own with pieceCount pieces of the same size.
+// Every generation is signed with the scheme returned by schemeFor for its
+// number, so signatures of different generations cannot be mixed up.
+typedef struct StreamLayout
+{
+    uint64_t totalLength;
+    int generationBytes;
+    int pieceCount;
+    bool packed;
+
+    StreamLayout(uint64_t totalLength, int generationBytes, int pieceCount, bool packed = false);
+
+    StreamLayout();
+
+    uint32_t Generations();
+
+    int GenerationLength(uint32_t generation);
+
+    int PieceSize();
+} StreamLayout;
+
+// Reads one generation at a time from in, so memory use is bounded by a
+// single generation whatever the stream length.
+template <typename T, typename S>
+class StreamEncoder
+{
+private:
+    std::istream *in;
+    std::function<T(uint32_t)> schemeFor;
+    uint32_t generation;
+    bool started;
+
+public:
+    StreamLayout layout;
+    FullRLNCEncoder<T, S> encoder;
+
+    StreamEncoder(std::istream &in, StreamLayout layout, std::function<T(uint32_t)> schemeFor, bool generateSystematic = true);
+
+    // Loads the next generation; false once the stream is exhausted.
+    bool NextGeneration();
+
+    uint32_t Generation();
+
+    CodedPiece<S> getCodedPiece();
+};
+
+// Decodes the generations of a stream and writes them to out in order as
+// they complete. Only the generations in [next, next + window) are kept,
+// pieces of later ones are refused.
+template <typename T, typename S>
+class StreamDecoder
+{
+private:
+    std::ostream *out;
+    std::function<T(uint32_t)> schemeFor;
+    std::map<uint32_t, FullRLNCDecoder<T, S>> pending;
+    uint32_t next;
+    uint32_t window;
+    bool sparse;
+
+    void flush();
+
+public:
+    StreamLayout layout;
+
+    StreamDecoder(std::ostream &out, StreamLayout layout, std::function<T(uint32_t)> schemeFor, uint32_t window = 4, bool sparse = false);
+
+    // Returns false when the piece was refused (generation out of window or
+    // already written out).
+    bool addPiece(uint32_t generation, CodedPiece<S> &piece);
+
+    // Number of generations written to out so far
+    uint32_t Written();
+
+    bool IsDecoded();
+};
+
+#endif
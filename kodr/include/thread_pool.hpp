@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+class ThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex lock;
+    std::condition_variable wake;
+    bool stopping;
+
+    void run();
+
+public:
+    ThreadPool(int threads);
+    ~ThreadPool();
+
+    int Size();
+
+    void Submit(std::function<void()> task);
+
+    // Runs task(i) for every i in [0, n) and returns once all of them are
+    // done. The calling thread takes part in the work, so it is safe to call
+    // from inside a task running on the same pool.
+    void ParallelFor(int n, const std::function<void(int)> &task);
+
+    // Process wide pool sized to the number of hardware threads.
+    static std::shared_ptr<ThreadPool> Shared();
+};
+
+#endif
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include "msm.hpp"
+
+#ifndef WORKSPACE_HPP
+#define WORKSPACE_HPP
+
+using namespace mcl::bls12;
+
+// Scratch buffers for Sign and Verify. Buffers are cleared but never shrunk,
+// so once they have grown to the size of a generation the schemes and the
+// multi-scalar multiplications below them stop allocating.
+typedef struct Workspace
+{
+    MSMTerms terms;
+    // nonzero entries of the hashed vectors
+    std::vector<int> indices;
+    // bytes hashed to a point or scalar
+    std::vector<uint8_t> hashInput;
+    // used inside MultiExp and the bucket kernels
+    std::vector<uint32_t> shortScalars;
+    std::vector<G1> buckets;
+} Workspace;
+
+// Workspace owned by the calling thread.
+Workspace &LocalWorkspace();
+
+// Appends the mcl::IoSerialize encoding of P, the bytes P.getStr(mcl::IoSerialize)
+// holds, without building a string.
+void appendPoint(std::vector<uint8_t> &buf, const G2 &P);
+
+#endif
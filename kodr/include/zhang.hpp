@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 #include "data.hpp"
+#include "pairing.hpp"
+#include "point_cache.hpp"
 
 #ifndef ZHANG_HPP
 #define ZHANG_HPP
@@ -18,6 +20,9 @@ class Zhang
         G2 hz;
         std::vector<uint8_t> nodeIDBytes;
         std::vector<uint8_t> fileIDBytes;
+        PrecomputedG2 hLines;
+        PointCache indexPoints; // h1(fileID, i)
+        PrecomputedG2 keyLines; // hr + hz * h0(hr, nodeID)
 
         // secret key components
         Fr y;
@@ -25,14 +30,25 @@ class Zhang
 
         Fr h0(G2 &element, std::vector<uint8_t> &extraBytes);
         G1 h1(std::vector<uint8_t> &inputBytes, uint8_t &index);
-        G1 AggregateHash(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
+        G1 AggregateHash(Span<const Fr> vec, Span<const Fr> codingVec);
         
     public:
+        // identifies the scheme in the wire header of coded pieces
+        static const uint8_t WireTag = 3;
         Zhang(std::string nodeID, std::string fileName);
         Zhang();
-        G1 Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec);
-        G1 Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs);
+        G1 Sign(Span<const Fr> vec, Span<const Fr> codingVec);
+        G1 Combine(std::vector<G1> &signs, Span<const Fr> coeffs);
         bool Verify(CodedPiece<G1> &encodedPiece);
+        std::vector<bool> VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces);
+
+        // Signing key for another node under the same master key.
+        Zhang Extract(std::string nodeID);
+        // Verifier for pieces signed by another node under the same master
+        // key, identified by its ID and the hr it publishes.
+        Zhang ForSender(std::string nodeID, G2 nodeKey);
+        G2 NodeKey();
+        size_t MemoryFootprint();
 };
 
 #endif
\ No newline at end of file
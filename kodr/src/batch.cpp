@@ -0,0 +1,146 @@
+#include <batch.hpp>
+#include <data.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <boneh.hpp>
+#include <li.hpp>
+#include <zhang.hpp>
+#include <catalano.hpp>
+#include <chang.hpp>
+#include <coefficients.hpp>
+
+template <typename T, typename S>
+bool verifyCombination(T &scheme, std::vector<CodedPiece<S>> &pieces, std::vector<int> &indices)
+{
+    if (indices.size() == 1)
+    {
+        return scheme.Verify(pieces[indices[0]]);
+    }
+    std::vector<Fr> weights = generateCodingVector(indices.size());
+    std::vector<Fr> buf(pieces[indices[0]].dataLen(), 0);
+    std::vector<S> sigs(indices.size());
+    for (int i = 0; i < indices.size(); i++)
+    {
+        CodedPiece<S> &p = pieces[indices[i]];
+        multiplyAdd(buf, p.buffer, weights[i]);
+        sigs[i] = p.signature;
+    }
+    CodedPiece<S> combined(std::move(buf), pieces[indices[0]].pieceSize, scheme.Combine(sigs, weights));
+    return scheme.Verify(combined);
+}
+
+template <typename T, typename S>
+void bisect(T &scheme, std::vector<CodedPiece<S>> &pieces, std::vector<int> &indices, std::vector<bool> &valid)
+{
+    if (indices.empty())
+    {
+        return;
+    }
+    if (verifyCombination(scheme, pieces, indices))
+    {
+        for (int i = 0; i < indices.size(); i++)
+        {
+            valid[indices[i]] = true;
+        }
+        return;
+    }
+    if (indices.size() == 1)
+    {
+        return;
+    }
+    std::vector<int> left(indices.begin(), indices.begin() + indices.size() / 2);
+    std::vector<int> right(indices.begin() + indices.size() / 2, indices.end());
+    bisect(scheme, pieces, left, valid);
+    bisect(scheme, pieces, right, valid);
+}
+
+template <typename T, typename S>
+std::vector<bool> BatchVerify(T &scheme, std::vector<CodedPiece<S>> &pieces)
+{
+    std::vector<bool> valid(pieces.size(), false);
+    if (pieces.empty())
+    {
+        return valid;
+    }
+
+    // pieces of a different shape cannot be combined, verify them one by one
+    std::vector<int> indices;
+    for (int i = 0; i < pieces.size(); i++)
+    {
+        if (pieces[i].pieceSize == pieces[0].pieceSize &&
+            pieces[i].dataLen() == pieces[0].dataLen())
+        {
+            indices.push_back(i);
+        }
+        else
+        {
+            valid[i] = scheme.Verify(pieces[i]);
+        }
+    }
+    bisect(scheme, pieces, indices, valid);
+    return valid;
+}
+
+const int SUBGROUP_ROUNDS = 64;
+
+const G1 &signaturePoint(const G1 &sig) { return sig; }
+
+const G1 &signaturePoint(const CatSignature &sig) { return sig.X; }
+
+template <typename S>
+std::vector<bool> CheckSubgroup(std::vector<CodedPiece<S>> &pieces)
+{
+    std::vector<bool> valid(pieces.size(), true);
+    if (pieces.size() > SUBGROUP_ROUNDS)
+    {
+        std::vector<uint32_t> masks((pieces.size() + 31) / 32);
+        bool passed = true;
+        for (int round = 0; round < SUBGROUP_ROUNDS && passed; round++)
+        {
+            G1 sum;
+            sum.clear();
+            LocalCoefficients().FillShort(masks.data(), masks.size(), 32);
+            for (int i = 0; i < pieces.size(); i++)
+            {
+                if ((masks[i / 32] >> (i % 32)) & 1)
+                {
+                    G1::add(sum, sum, signaturePoint(pieces[i].signature));
+                }
+            }
+            passed = sum.isValidOrder();
+        }
+        if (passed)
+        {
+            return valid;
+        }
+    }
+    for (int i = 0; i < pieces.size(); i++)
+    {
+        valid[i] = signaturePoint(pieces[i].signature).isValidOrder();
+    }
+    return valid;
+}
+
+template <typename S>
+std::vector<bool> DeserializeBatch(std::vector<CodedPiece<S>> &pieces, const uint8_t *buf, size_t bufLen,
+                                   uint8_t schemeTag, int pieceCount)
+{
+    pieces.clear();
+    size_t offset = 0;
+    while (offset < bufLen)
+    {
+        pieces.emplace_back();
+        offset += pieces.back().deserialize(buf + offset, bufLen - offset, schemeTag, pieceCount, false);
+    }
+    return CheckSubgroup(pieces);
+}
+
+template std::vector<bool> BatchVerify<Boneh, G1>(Boneh &, std::vector<CodedPiece<G1>> &);
+template std::vector<bool> BatchVerify<Li, G1>(Li &, std::vector<CodedPiece<G1>> &);
+template std::vector<bool> BatchVerify<Zhang, G1>(Zhang &, std::vector<CodedPiece<G1>> &);
+template std::vector<bool> BatchVerify<Catalano, CatSignature>(Catalano &, std::vector<CodedPiece<CatSignature>> &);
+template std::vector<bool> BatchVerify<Chang, G1>(Chang &, std::vector<CodedPiece<G1>> &);
+template std::vector<bool> CheckSubgroup<G1>(std::vector<CodedPiece<G1>> &);
+template std::vector<bool> CheckSubgroup<CatSignature>(std::vector<CodedPiece<CatSignature>> &);
+template std::vector<bool> DeserializeBatch<G1>(std::vector<CodedPiece<G1>> &, const uint8_t *, size_t, uint8_t, int);
+template std::vector<bool> DeserializeBatch<CatSignature>(std::vector<CodedPiece<CatSignature>> &, const uint8_t *, size_t, uint8_t, int);
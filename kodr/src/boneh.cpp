@@ -1,38 +1,56 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <boneh.hpp>
+#include <batch.hpp>
+#include <workspace.hpp>
 #include <random>
 
-Boneh::Boneh(int pieceSize, std::string fileName)
+Boneh::Boneh(int pieceSize, std::string fileName, size_t tableBudget)
 {
     id = fileName + RandomString(6);
     generators = std::vector<G1>(pieceSize);
     mapToG2(h, rand());
     alpha.setRand();
     G2::mul(u, h, alpha);
+    hLines = PrecomputedG2(h);
+    uLines = PrecomputedG2(u);
     for (int i = 0; i < generators.size(); i++)
     {
         mapToG1(generators[i], rand());
     }
+    generatorTable = FixedBaseMSM(generators, tableBudget);
 }
 
 Boneh::Boneh(){};
 
-void Boneh::AggregateHash(G1 &P, std::vector<Fr> &vec, std::vector<Fr> &codingVec)
+void Boneh::AggregateHash(G1 &P, Span<const Fr> vec, Span<const Fr> codingVec)
 {
-    std::vector<G1> fullPoints(generators.size() + codingVec.size());
-    std::vector<Fr> fullVec(vec.size() + codingVec.size());
-    std::copy(vec.begin(), vec.end(), fullVec.begin());
-    std::copy(codingVec.begin(), codingVec.end(), fullVec.begin() + vec.size());
-    std::copy(generators.begin(), generators.end(), fullPoints.begin());
-    for (int i = 0; i < codingVec.size(); i++)
+    // only the index points of nonzero coefficients are needed
+    Workspace &ws = LocalWorkspace();
+    std::vector<int> &indices = ws.indices;
+    indices.clear();
+    appendNonZeroIndices(indices, codingVec);
+    std::shared_ptr<const std::vector<G1>> hashes = indexPoints.GetSome(indices, [this](G1 &P, int i)
+                                                                        { hashAndMapToG1(P, id + std::to_string(i)); });
+    MSMTerms &terms = ws.terms;
+    terms.Clear();
+    for (int i = 0; i < indices.size(); i++)
     {
-        hashAndMapToG1(fullPoints[i + generators.size()], id + std::to_string(i));
+        terms.Add((*hashes)[indices[i]], codingVec[indices[i]]);
     }
-    G1::mulVec(P, fullPoints.data(), fullVec.data(), fullVec.size());
+    if (!generatorTable.Enabled())
+    {
+        terms.AddNonZero(generators.data(), vec.data(), vec.size());
+        terms.Eval(P);
+        return;
+    }
+    G1 indexPart;
+    terms.Eval(indexPart);
+    generatorTable.MulVec(P, vec.data(), vec.size());
+    P += indexPart;
 }
 
-G1 Boneh::Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec)
+G1 Boneh::Sign(Span<const Fr> vec, Span<const Fr> codingVec)
 {
     G1 sig;
     AggregateHash(sig, vec, codingVec);
@@ -40,19 +58,21 @@ G1 Boneh::Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec)
     return sig;
 }
 
-G1 Boneh::Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs)
+G1 Boneh::Combine(std::vector<G1> &signs, Span<const Fr> coeffs)
 {
     G1 sig;
-    G1::mulVec(sig, signs.data(), coeffs.data(), signs.size());
+    MultiExp(sig, signs.data(), coeffs.data(), signs.size());
     return sig;
 }
 
 bool Boneh::Verify(CodedPiece<G1> &encodedPiece)
 {
-    Fp12 e1, e2;
     G1 hashed;
-    AggregateHash(hashed, encodedPiece.piece, encodedPiece.codingVector);
-    pairing(e1, encodedPiece.signature, h); // e1 = e(signature, h)
-    pairing(e2, hashed, u);                 // e2 = e(hashed, u)
-    return e1 == e2;
+    AggregateHash(hashed, encodedPiece.piece(), encodedPiece.codingVector());
+    return PairingsEqual(encodedPiece.signature, hLines, hashed, uLines); // e(signature, h) == e(hashed, u)
+}
+
+std::vector<bool> Boneh::VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces)
+{
+    return BatchVerify(*this, encodedPieces);
 }
\ No newline at end of file
@@ -1,15 +1,20 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <catalano.hpp>
+#include <batch.hpp>
+#include <workspace.hpp>
 #include <random>
 
-Catalano::Catalano(uint8_t numPieces, uint8_t pieceSize, Fr fileID)
+Catalano::Catalano(uint8_t numPieces, uint8_t pieceSize, Fr fileID, size_t tableBudget)
 {
     fid = fileID;
     mapToG1(g, rand());
     z.setRand();
     mapToG2(gPrime, rand());
     bigZ = gPrime * z;
+    signExp = 1 / (fid + z);
+    gPrimeLines = PrecomputedG2(gPrime);
+    keyLines = PrecomputedG2(bigZ + (gPrime * fid));
 
     mapToG1(h, rand());
     hVec.resize(numPieces);
@@ -22,31 +27,66 @@ Catalano::Catalano(uint8_t numPieces, uint8_t pieceSize, Fr fileID)
     {
         mapToG1(gVec[i], rand());
     }
+    // split the budget in proportion to the number of bases
+    size_t hBudget = tableBudget * numPieces / (numPieces + pieceSize);
+    hTable = FixedBaseMSM(hVec, hBudget);
+    gTable = FixedBaseMSM(gVec, tableBudget - hBudget);
 }
 
 Catalano::Catalano(){};
 
-G1 Catalano::AggregateHash(Fr secret, std::vector<Fr> &vec, std::vector<Fr> &codingVec) {
+G1 Catalano::MessageHash(Span<const Fr> vec, Span<const Fr> codingVec) {
     G1 multiExp1;
     G1 multiExp2;
-    G1::mulVec(multiExp1, hVec.data(), codingVec.data(), codingVec.size());
-    G1::mulVec(multiExp2, gVec.data(), vec.data(), vec.size());
-    G1 sig = h * secret + multiExp1 + multiExp2;
+    if (hTable.Enabled())
+    {
+        hTable.MulVec(multiExp1, codingVec.data(), codingVec.size());
+    }
+    else
+    {
+        MSMTerms &terms = LocalWorkspace().terms;
+        terms.Clear();
+        terms.AddNonZero(hVec.data(), codingVec.data(), codingVec.size());
+        terms.Eval(multiExp1);
+    }
+    if (gTable.Enabled())
+    {
+        gTable.MulVec(multiExp2, vec.data(), vec.size());
+    }
+    else
+    {
+        MSMTerms &terms = LocalWorkspace().terms;
+        terms.Clear();
+        terms.AddNonZero(gVec.data(), vec.data(), vec.size());
+        terms.Eval(multiExp2);
+    }
+    return multiExp1 + multiExp2;
+}
+
+G1 Catalano::AggregateHash(Fr secret, Span<const Fr> vec, Span<const Fr> codingVec) {
+    G1 sig = h * secret + MessageHash(vec, codingVec);
     return sig;
 }
 
-CatSignature Catalano::Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec)
+CatSignature Catalano::Sign(Span<const Fr> vec, Span<const Fr> codingVec)
 {
-    Fr s;
-    s.setRand();
-    Fr bigExp = 1 / (fid + z);
+    CatRandomness r;
+    if (pool)
+    {
+        r = pool->Take();
+    }
+    else
+    {
+        r.s.setRand();
+        G1::mul(r.hs, h, r.s);
+    }
 
-    G1 X = AggregateHash(s, vec, codingVec);
-    X = X * bigExp;
-    return CatSignature{X, s};
+    G1 X = r.hs + MessageHash(vec, codingVec);
+    X = X * signExp;
+    return CatSignature{X, r.s};
 }
 
-CatSignature Catalano::Combine(std::vector<CatSignature> &signs, std::vector<Fr> &coeffs)
+CatSignature Catalano::Combine(std::vector<CatSignature> &signs, Span<const Fr> coeffs)
 {
     G1 newX;
     Fr newS = 0;
@@ -55,15 +95,97 @@ CatSignature Catalano::Combine(std::vector<CatSignature> &signs, std::vector<Fr>
         XVec[i] = signs[i].X;
         newS += signs[i].s * coeffs[i];
     }
-    G1::mulVec(newX, XVec.data(), coeffs.data(), coeffs.size());
+    MultiExp(newX, XVec.data(), coeffs.data(), coeffs.size());
     return CatSignature{newX, newS};
 }
 
 bool Catalano::Verify(CodedPiece<CatSignature> &encodedPiece)
 {
-    Fp12 e1, e2;
-    pairing(e1, encodedPiece.signature.X, bigZ + (gPrime * fid));
-    G1 hashed = AggregateHash(encodedPiece.signature.s, encodedPiece.piece, encodedPiece.codingVector);
-    pairing(e2, hashed, gPrime);
-    return e1 == e2;
+    G1 hashed = AggregateHash(encodedPiece.signature.s, encodedPiece.piece(), encodedPiece.codingVector());
+    return PairingsEqual(encodedPiece.signature.X, keyLines, hashed, gPrimeLines);
+}
+
+std::vector<bool> Catalano::VerifyBatch(std::vector<CodedPiece<CatSignature>> &encodedPieces)
+{
+    return BatchVerify(*this, encodedPieces);
+}
+
+void Catalano::StartOfflinePool(int capacity)
+{
+    pool = std::make_shared<CatRandomnessPool>(h, capacity);
+}
+
+void Catalano::StopOfflinePool() { pool.reset(); }
+
+int Catalano::OfflinePoolSize()
+{
+    if (!pool)
+    {
+        return 0;
+    }
+    return pool->Size();
+}
+
+CatRandomnessPool::CatRandomnessPool(G1 h, int capacity)
+{
+    this->h = h;
+    this->capacity = capacity;
+    this->stopping = false;
+    this->worker = std::thread(&CatRandomnessPool::run, this);
+}
+
+CatRandomnessPool::~CatRandomnessPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    refill.notify_all();
+    worker.join();
+}
+
+void CatRandomnessPool::run()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            refill.wait(guard, [this]
+                        { return stopping || ready.size() < capacity; });
+            if (stopping)
+            {
+                return;
+            }
+        }
+        CatRandomness r;
+        r.s.setRand();
+        G1::mul(r.hs, h, r.s);
+        std::lock_guard<std::mutex> guard(lock);
+        ready.push_back(r);
+    }
+}
+
+// Falls back to computing the pair inline when the pool has run dry.
+CatRandomness CatRandomnessPool::Take()
+{
+    CatRandomness r;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!ready.empty())
+        {
+            r = ready.front();
+            ready.pop_front();
+            refill.notify_one();
+            return r;
+        }
+    }
+    r.s.setRand();
+    G1::mul(r.hs, h, r.s);
+    return r;
+}
+
+int CatRandomnessPool::Size()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return ready.size();
 }
\ No newline at end of file
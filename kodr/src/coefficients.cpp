@@ -0,0 +1,146 @@
+#include <coefficients.hpp>
+#include <mcl/bls12_381.hpp>
+#include <random>
+#include <cstring>
+
+const int BLOCKS = 4;
+const int ELEMENT_BYTES = 32;
+
+static inline uint32_t rotl(uint32_t x, int n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+#define QUARTER(a, b, c, d)           \
+    a += b, d = rotl(d ^ a, 16);      \
+    c += d, b = rotl(b ^ c, 12);      \
+    a += b, d = rotl(d ^ a, 8);       \
+    c += d, b = rotl(b ^ c, 7);
+
+CoefficientGenerator::CoefficientGenerator()
+{
+    Reseed();
+}
+
+CoefficientGenerator::CoefficientGenerator(uint64_t seed)
+{
+    Seed(seed);
+}
+
+void CoefficientGenerator::Reseed()
+{
+    std::random_device rd;
+    uint8_t key[32];
+    for (int i = 0; i < 32; i += 4)
+    {
+        uint32_t w = rd();
+        std::memcpy(key + i, &w, 4);
+    }
+    Seed(key);
+}
+
+void CoefficientGenerator::Seed(const uint8_t key[32])
+{
+    // "expand 32-byte k"
+    state[0] = 0x61707865;
+    state[1] = 0x3320646e;
+    state[2] = 0x79622d32;
+    state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++)
+    {
+        state[4 + i] = key[4 * i] | (key[4 * i + 1] << 8) | (key[4 * i + 2] << 16) | ((uint32_t)key[4 * i + 3] << 24);
+    }
+    for (int i = 12; i < 16; i++)
+    {
+        state[i] = 0;
+    }
+    used = sizeof(block);
+}
+
+void CoefficientGenerator::Seed(uint64_t seed)
+{
+    uint8_t key[32] = {0};
+    for (int i = 0; i < 8; i++)
+    {
+        key[i] = seed >> (8 * i);
+    }
+    Seed(key);
+}
+
+void CoefficientGenerator::refill()
+{
+    // the blocks are independent, so the compiler can interleave them
+    uint32_t x[BLOCKS][16];
+    for (int b = 0; b < BLOCKS; b++)
+    {
+        std::memcpy(x[b], state, sizeof(state));
+        x[b][12] += b;
+    }
+    for (int round = 0; round < 10; round++)
+    {
+        for (int b = 0; b < BLOCKS; b++)
+        {
+            uint32_t *s = x[b];
+            QUARTER(s[0], s[4], s[8], s[12])
+            QUARTER(s[1], s[5], s[9], s[13])
+            QUARTER(s[2], s[6], s[10], s[14])
+            QUARTER(s[3], s[7], s[11], s[15])
+            QUARTER(s[0], s[5], s[10], s[15])
+            QUARTER(s[1], s[6], s[11], s[12])
+            QUARTER(s[2], s[7], s[8], s[13])
+            QUARTER(s[3], s[4], s[9], s[14])
+        }
+    }
+    for (int b = 0; b < BLOCKS; b++)
+    {
+        for (int i = 0; i < 16; i++)
+        {
+            uint32_t w = x[b][i] + state[i] + (i == 12 ? b : 0);
+            uint8_t *out = block + 64 * b + 4 * i;
+            out[0] = w;
+            out[1] = w >> 8;
+            out[2] = w >> 16;
+            out[3] = w >> 24;
+        }
+    }
+    state[12] += BLOCKS;
+    if (state[12] < BLOCKS)
+    {
+        state[13]++;
+    }
+    used = 0;
+}
+
+void CoefficientGenerator::Fill(Fr *out, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        if (used + ELEMENT_BYTES > sizeof(block))
+        {
+            refill();
+        }
+        out[i].setArrayMask(block + used, ELEMENT_BYTES);
+        used += ELEMENT_BYTES;
+    }
+}
+
+void CoefficientGenerator::FillShort(uint32_t *out, int n, int bits)
+{
+    uint32_t mask = bits >= 32 ? 0xffffffff : (1u << bits) - 1;
+    for (int i = 0; i < n; i++)
+    {
+        if (used + 4 > sizeof(block))
+        {
+            refill();
+        }
+        const uint8_t *w = block + used;
+        out[i] = (w[0] | (w[1] << 8) | (w[2] << 16) | ((uint32_t)w[3] << 24)) & mask;
+        used += 4;
+    }
+}
+
+CoefficientGenerator &LocalCoefficients()
+{
+    thread_local CoefficientGenerator generator;
+    return generator;
+}
@@ -3,7 +3,10 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <random>
+#include <stdexcept>
+#include <algorithm>
 #include <catalano.hpp>
+#include <coefficients.hpp>
 
 using namespace mcl::bls12;
 
@@ -16,19 +19,60 @@ std::vector<Fr> multiply(std::vector<Fr> piece1, std::vector<Fr> piece2, Fr by)
     return piece1;
 }
 
+void multiplyAdd(Span<Fr> acc, Span<const Fr> piece, const Fr &by)
+{
+    for (int i = 0; i < acc.size(); i++)
+    {
+        acc[i] += piece[i] * by;
+    }
+}
+
+std::vector<int> nonZeroIndices(Span<const Fr> vec, int begin)
+{
+    std::vector<int> ret;
+    for (int i = begin; i < vec.size(); i++)
+    {
+        if (!vec[i].isZero())
+        {
+            ret.push_back(i);
+        }
+    }
+    return ret;
+}
+
+void appendNonZeroIndices(std::vector<int> &out, Span<const Fr> vec, int offset)
+{
+    for (int i = 0; i < vec.size(); i++)
+    {
+        if (!vec[i].isZero())
+        {
+            out.push_back(offset + i);
+        }
+    }
+}
+
 template <typename T>
 CodedPiece<T>::CodedPiece(std::vector<Fr> p, std::vector<Fr> v, T s)
 {
-    piece = p;
-    codingVector = v;
+    buffer = std::move(p);
+    pieceSize = buffer.size();
+    buffer.insert(buffer.end(), v.begin(), v.end());
+    signature = s;
+}
+
+template <typename T>
+CodedPiece<T>::CodedPiece(std::vector<Fr> &&buffer, int pieceSize, T s)
+{
+    this->buffer = std::move(buffer);
+    this->pieceSize = pieceSize;
     signature = s;
 }
 
 template <typename T>
 CodedPiece<T>::CodedPiece(std::vector<uint8_t> &bytes, const int &pieceSize, const int &codingVectorSize)
 {
-    piece.resize(pieceSize);
-    codingVector.resize(codingVectorSize);
+    this->pieceSize = pieceSize;
+    buffer.resize(pieceSize + codingVectorSize);
     std::vector<uint8_t> tempArr(32);
     std::string tempString;
 
@@ -36,13 +80,13 @@ CodedPiece<T>::CodedPiece(std::vector<uint8_t> &bytes, const int &pieceSize, con
     {
         tempArr = std::vector<uint8_t>(bytes.begin() + i * 32, bytes.begin() + (i + 1) * 32);
         tempString = std::string(tempArr.begin(), tempArr.end());
-        piece[i].setStr(tempString, mcl::IoSerialize);
+        buffer[i].setStr(tempString, mcl::IoSerialize);
     }
     for (int i = pieceSize; i < pieceSize + codingVectorSize; i++)
     {
         tempArr = std::vector<uint8_t>(bytes.begin() + i * 32, bytes.begin() + (i + 1) * 32);
         tempString = std::string(tempArr.begin(), tempArr.end());
-        codingVector[i - pieceSize].setStr(tempString, mcl::IoSerialize);
+        buffer[i].setStr(tempString, mcl::IoSerialize);
     }
     tempArr = std::vector<uint8_t>(bytes.begin() + (pieceSize + codingVectorSize) * 32, bytes.end());
     tempString = std::string(tempArr.begin(), tempArr.end());
@@ -52,8 +96,8 @@ CodedPiece<T>::CodedPiece(std::vector<uint8_t> &bytes, const int &pieceSize, con
 template <>
 CodedPiece<CatSignature>::CodedPiece(std::vector<uint8_t> &bytes, const int &pieceSize, const int &codingVectorSize)
 {
-    piece.resize(pieceSize);
-    codingVector.resize(codingVectorSize);
+    this->pieceSize = pieceSize;
+    buffer.resize(pieceSize + codingVectorSize);
     std::vector<uint8_t> tempArr(32);
     std::string tempString;
 
@@ -61,13 +105,13 @@ CodedPiece<CatSignature>::CodedPiece(std::vector<uint8_t> &bytes, const int &pie
     {
         tempArr = std::vector<uint8_t>(bytes.begin() + i * 32, bytes.begin() + (i + 1) * 32);
         tempString = std::string(tempArr.begin(), tempArr.end());
-        piece[i].setStr(tempString, mcl::IoSerialize);
+        buffer[i].setStr(tempString, mcl::IoSerialize);
     }
     for (int i = pieceSize; i < pieceSize + codingVectorSize; i++)
     {
         tempArr = std::vector<uint8_t>(bytes.begin() + i * 32, bytes.begin() + (i + 1) * 32);
         tempString = std::string(tempArr.begin(), tempArr.end());
-        codingVector[i - pieceSize].setStr(tempString, mcl::IoSerialize);
+        buffer[i].setStr(tempString, mcl::IoSerialize);
     }
     tempArr = std::vector<uint8_t>(bytes.begin() + (pieceSize + codingVectorSize) * 32, bytes.end());
     tempString = std::string(tempArr.begin(), tempArr.end());
@@ -81,7 +125,7 @@ template <typename T>
 CodedPiece<T>::CodedPiece(){};
 
 template <typename T>
-int CodedPiece<T>::dataLen() { return piece.size() + codingVector.size(); }
+int CodedPiece<T>::dataLen() { return buffer.size(); }
 
 template <typename T>
 int CodedPiece<T>::fullLen()
@@ -94,13 +138,7 @@ int CodedPiece<T>::fullLen()
 }
 
 template <typename T>
-std::vector<Fr> CodedPiece<T>::flatten()
-{
-    std::vector<Fr> ret(dataLen());
-    std::copy(piece.begin(), piece.end(), ret.begin());
-    std::copy(codingVector.begin(), codingVector.end(), ret.begin() + piece.size());
-    return ret;
-}
+std::vector<Fr> CodedPiece<T>::flatten() { return buffer; }
 
 template <typename T>
 std::vector<uint8_t> CodedPiece<T>::toBytes()
@@ -108,18 +146,12 @@ std::vector<uint8_t> CodedPiece<T>::toBytes()
     std::vector<uint8_t> ret(fullLen());
     std::vector<uint8_t> tempArr(32);
     std::string tempString;
-    for (int i = 0; i < piece.size(); i++)
+    for (int i = 0; i < dataLen(); i++)
     {
-        tempString = piece[i].getStr(mcl::IoSerialize);
+        tempString = buffer[i].getStr(mcl::IoSerialize);
         tempArr = std::vector<uint8_t>(tempString.begin(), tempString.end());
         std::copy(tempArr.begin(), tempArr.end(), ret.begin() + i * 32);
     }
-    for (int i = 0; i < codingVector.size(); i++)
-    {
-        tempString = codingVector[i].getStr(mcl::IoSerialize);
-        tempArr = std::vector<uint8_t>(tempString.begin(), tempString.end());
-        std::copy(tempArr.begin(), tempArr.end(), ret.begin() + (piece.size() + i) * 32);
-    }
     tempString = signature.getStr(mcl::IoSerialize);
     tempArr = std::vector<uint8_t>(tempString.begin(), tempString.end());
     std::copy(tempArr.begin(), tempArr.end(), ret.begin() + dataLen() * 32);
@@ -132,18 +164,12 @@ std::vector<uint8_t> CodedPiece<CatSignature>::toBytes()
     std::vector<uint8_t> ret(fullLen());
     std::vector<uint8_t> tempArr(32);
     std::string tempString;
-    for (int i = 0; i < piece.size(); i++)
+    for (int i = 0; i < dataLen(); i++)
     {
-        tempString = piece[i].getStr(mcl::IoSerialize);
+        tempString = buffer[i].getStr(mcl::IoSerialize);
         tempArr = std::vector<uint8_t>(tempString.begin(), tempString.end());
         std::copy(tempArr.begin(), tempArr.end(), ret.begin() + i * 32);
     }
-    for (int i = 0; i < codingVector.size(); i++)
-    {
-        tempString = codingVector[i].getStr(mcl::IoSerialize);
-        tempArr = std::vector<uint8_t>(tempString.begin(), tempString.end());
-        std::copy(tempArr.begin(), tempArr.end(), ret.begin() + (piece.size() + i) * 32);
-    }
     tempString = signature.X.getStr(mcl::IoSerialize);
     tempArr = std::vector<uint8_t>(tempString.begin(), tempString.end());
     std::copy(tempArr.begin(), tempArr.end(), ret.begin() + dataLen() * 32);
@@ -153,16 +179,347 @@ std::vector<uint8_t> CodedPiece<CatSignature>::toBytes()
     return ret;
 }
 
+void putU32(uint8_t *buf, uint32_t x)
+{
+    for (int i = 0; i < 4; i++)
+    {
+        buf[i] = x >> (8 * i);
+    }
+}
+
+uint32_t getU32(const uint8_t *buf)
+{
+    return buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+int pointMode(uint16_t flags) { return (flags & WIRE_UNCOMPRESSED) ? mcl::IoEcAffineSerialize : mcl::IoSerialize; }
+
+size_t pointLen(uint16_t flags) { return (flags & WIRE_UNCOMPRESSED) ? 2 * G1_BYTES : G1_BYTES; }
+
+size_t signatureLen(const G1 &, uint16_t flags) { return pointLen(flags); }
+
+size_t signatureLen(const CatSignature &, uint16_t flags) { return pointLen(flags) + FR_BYTES; }
+
+size_t writeSignature(uint8_t *buf, const G1 &sig, uint16_t flags)
+{
+    return sig.serialize(buf, pointLen(flags), pointMode(flags));
+}
+
+size_t writeSignature(uint8_t *buf, const CatSignature &sig, uint16_t flags)
+{
+    size_t n = sig.X.serialize(buf, pointLen(flags), pointMode(flags));
+    if (n == 0)
+    {
+        return 0;
+    }
+    return n + sig.s.serialize(buf + n, FR_BYTES);
+}
+
+// Coefficient b of the BLS12-381 G1 curve y^2 = x^3 + b.
+const int G1_CURVE_B = 4;
+
+// Reads a point in mcl's serialized layout checking only that it lies on the
+// curve. mcl's own deserializer also checks the order unless that is turned
+// off process wide.
+bool readPointOnCurve(G1 &P, const uint8_t *buf, uint16_t flags)
+{
+    Fp x, y;
+    if (flags & WIRE_UNCOMPRESSED)
+    {
+        if (x.deserialize(buf, G1_BYTES) == 0 || y.deserialize(buf + G1_BYTES, G1_BYTES) == 0)
+        {
+            return false;
+        }
+        if (x.isZero() && y.isZero())
+        {
+            P.clear();
+            return true;
+        }
+        if (y * y != x * x * x + Fp(G1_CURVE_B))
+        {
+            return false;
+        }
+    }
+    else
+    {
+        if (std::all_of(buf, buf + G1_BYTES, [](uint8_t b) { return b == 0; }))
+        {
+            P.clear();
+            return true;
+        }
+        uint8_t bytes[G1_BYTES];
+        std::copy(buf, buf + G1_BYTES, bytes);
+        bool odd = bytes[G1_BYTES - 1] >> 7;
+        bytes[G1_BYTES - 1] &= 0x7f;
+        if (x.deserialize(bytes, G1_BYTES) == 0 || !Fp::squareRoot(y, x * x * x + Fp(G1_CURVE_B)))
+        {
+            return false;
+        }
+        if (y.isOdd() != odd)
+        {
+            Fp::neg(y, y);
+        }
+    }
+    P.x = x;
+    P.y = y;
+    P.z = 1;
+    return true;
+}
+
+size_t readPoint(G1 &P, const uint8_t *buf, uint16_t flags, bool checkOrder)
+{
+    if (checkOrder)
+    {
+        return P.deserialize(buf, pointLen(flags), pointMode(flags));
+    }
+    return readPointOnCurve(P, buf, flags) ? pointLen(flags) : 0;
+}
+
+size_t readSignature(G1 &sig, const uint8_t *buf, uint16_t flags, bool checkOrder)
+{
+    return readPoint(sig, buf, flags, checkOrder);
+}
+
+size_t readSignature(CatSignature &sig, const uint8_t *buf, uint16_t flags, bool checkOrder)
+{
+    size_t n = readPoint(sig.X, buf, flags, checkOrder);
+    if (n == 0)
+    {
+        return 0;
+    }
+    return n + sig.s.deserialize(buf + n, FR_BYTES);
+}
+
+template <typename T>
+size_t CodedPiece<T>::wireLen(uint16_t flags)
+{
+    size_t vectorLen = (buffer.size() - pieceSize) * FR_BYTES;
+    if ((flags & WIRE_SEEDED) && seeded)
+    {
+        vectorLen = SEED_BYTES;
+    }
+    return WIRE_HEADER_LEN + (size_t)pieceSize * FR_BYTES + vectorLen + signatureLen(signature, flags);
+}
+
+template <typename T>
+size_t CodedPiece<T>::serialize(uint8_t *buf, size_t bufLen, uint8_t schemeTag, uint16_t flags)
+{
+    if (flags & ~WIRE_KNOWN_FLAGS)
+    {
+        throw std::invalid_argument("Unknown coded piece flags!");
+    }
+    if (!seeded)
+    {
+        flags &= ~WIRE_SEEDED;
+    }
+    if (bufLen < wireLen(flags))
+    {
+        throw std::length_error("Buffer too small for coded piece!");
+    }
+    buf[0] = WIRE_VERSION;
+    buf[1] = schemeTag;
+    buf[2] = flags;
+    buf[3] = flags >> 8;
+    putU32(buf + 4, pieceSize);
+    putU32(buf + 8, buffer.size() - pieceSize);
+    uint8_t *out = buf + WIRE_HEADER_LEN;
+    for (int i = 0; i < pieceSize; i++, out += FR_BYTES)
+    {
+        buffer[i].serialize(out, FR_BYTES);
+    }
+    if (flags & WIRE_SEEDED)
+    {
+        for (int j = 0; j < SEED_BYTES; j++)
+        {
+            *out++ = seed >> (8 * j);
+        }
+    }
+    else
+    {
+        for (int i = pieceSize; i < buffer.size(); i++, out += FR_BYTES)
+        {
+            buffer[i].serialize(out, FR_BYTES);
+        }
+    }
+    if (writeSignature(out, signature, flags) != signatureLen(signature, flags))
+    {
+        throw std::runtime_error("Could not serialize signature!");
+    }
+    return wireLen(flags);
+}
+
+template <typename T>
+size_t CodedPiece<T>::deserialize(const uint8_t *buf, size_t bufLen, uint8_t schemeTag, int pieceCount, bool checkOrder)
+{
+    if (bufLen < WIRE_HEADER_LEN)
+    {
+        throw std::length_error("Truncated coded piece header!");
+    }
+    if (buf[0] != WIRE_VERSION)
+    {
+        throw std::runtime_error("Unsupported coded piece version!");
+    }
+    if (buf[1] != schemeTag)
+    {
+        throw std::runtime_error("Coded piece is signed with another scheme!");
+    }
+    uint16_t flags = buf[2] | (buf[3] << 8);
+    if (flags & ~WIRE_KNOWN_FLAGS)
+    {
+        throw std::runtime_error("Unknown coded piece flags!");
+    }
+    uint32_t wirePieceSize = getU32(buf + 4);
+    uint32_t codingVectorSize = getU32(buf + 8);
+    if (pieceCount < 0 || codingVectorSize != (uint32_t)pieceCount)
+    {
+        throw std::runtime_error("Coding vector does not match the piece count!");
+    }
+    size_t sigLen = signatureLen(signature, flags);
+    size_t vectorLen = (flags & WIRE_SEEDED) ? SEED_BYTES : 0;
+    size_t elements = (size_t)wirePieceSize + ((flags & WIRE_SEEDED) ? 0 : codingVectorSize);
+    if (bufLen < WIRE_HEADER_LEN + vectorLen + sigLen ||
+        (bufLen - WIRE_HEADER_LEN - vectorLen - sigLen) / FR_BYTES < elements)
+    {
+        throw std::length_error("Truncated coded piece!");
+    }
+    pieceSize = wirePieceSize;
+    buffer.resize((size_t)pieceSize + codingVectorSize);
+    const uint8_t *in = buf + WIRE_HEADER_LEN;
+    for (int i = 0; i < pieceSize; i++, in += FR_BYTES)
+    {
+        if (buffer[i].deserialize(in, FR_BYTES) == 0)
+        {
+            throw std::runtime_error("Invalid field element in coded piece!");
+        }
+    }
+    seeded = flags & WIRE_SEEDED;
+    if (seeded)
+    {
+        seed = 0;
+        for (int j = 0; j < SEED_BYTES; j++)
+        {
+            seed |= (uint64_t)*in++ << (8 * j);
+        }
+        CoefficientGenerator(seed).Fill(buffer.data() + pieceSize, codingVectorSize);
+    }
+    else
+    {
+        for (int i = pieceSize; i < buffer.size(); i++, in += FR_BYTES)
+        {
+            if (buffer[i].deserialize(in, FR_BYTES) == 0)
+            {
+                throw std::runtime_error("Invalid field element in coded piece!");
+            }
+        }
+    }
+    if (readSignature(signature, in, flags, checkOrder) != sigLen)
+    {
+        throw std::runtime_error("Invalid signature in coded piece!");
+    }
+    return wireLen(flags);
+}
+
 std::vector<Fr> generateCodingVector(int n)
 {
     std::vector<Fr> ret(n);
+    LocalCoefficients().Fill(ret.data(), n);
+    return ret;
+}
+
+std::vector<uint32_t> generateShortCoefficients(int n, int bits)
+{
+    if (bits <= 0 || bits > 32)
+    {
+        throw std::invalid_argument("Short coefficients must have 1 to 32 bits!");
+    }
+    std::vector<uint32_t> ret(n);
+    LocalCoefficients().FillShort(ret.data(), n, bits);
+    return ret;
+}
+
+std::vector<int> sparseSupport(int n, double density)
+{
+    if (density <= 0 || density > 1)
+    {
+        throw std::invalid_argument("Density must be in (0, 1]!");
+    }
+    std::vector<int> ret;
+    std::vector<uint32_t> draws(n);
+    LocalCoefficients().FillShort(draws.data(), n, 32);
+    uint32_t threshold = density >= 1 ? 0xffffffff : (uint32_t)(density * 4294967296.0);
     for (int i = 0; i < n; i++)
     {
-        ret[i].setRand();
+        if (draws[i] < threshold || density >= 1)
+        {
+            ret.push_back(i);
+        }
+    }
+    if (ret.empty() && n > 0)
+    {
+        uint32_t pick;
+        LocalCoefficients().FillShort(&pick, 1, 32);
+        ret.push_back(pick % n);
     }
     return ret;
 }
 
+std::vector<Fr> generateSparseCodingVector(int n, double density)
+{
+    std::vector<int> support = sparseSupport(n, density);
+    std::vector<Fr> values(support.size());
+    LocalCoefficients().Fill(values.data(), values.size());
+    std::vector<Fr> ret(n, 0);
+    for (int i = 0; i < support.size(); i++)
+    {
+        ret[support[i]] = values[i];
+    }
+    return ret;
+}
+
+std::vector<Fr> shortToField(const std::vector<uint32_t> &coeffs)
+{
+    std::vector<Fr> ret(coeffs.size());
+    for (int i = 0; i < coeffs.size(); i++)
+    {
+        ret[i] = (int64_t)coeffs[i];
+    }
+    return ret;
+}
+
+void multiplyAddShort(Span<Fr> acc, Span<const Fr> piece, uint32_t by)
+{
+    if (by == 0)
+    {
+        return;
+    }
+    Fr t;
+    for (int i = 0; i < acc.size(); i++)
+    {
+        Fr::mulUnit(t, piece[i], by);
+        Fr::add(acc[i], acc[i], t);
+    }
+}
+
+double NonInnovativeProbability(int coefficientBits)
+{
+    // the group order is above 2^254
+    return ldexp(1.0, -(coefficientBits > 0 ? coefficientBits : 254));
+}
+
+uint64_t generateSeed()
+{
+    std::random_device rd;
+    return ((uint64_t)rd() << 32) | rd();
+}
+
+std::vector<Fr> expandCodingVector(uint64_t seed, int n)
+{
+    std::vector<Fr> ret(n);
+    CoefficientGenerator generator(seed);
+    generator.Fill(ret.data(), n);
+    return ret;
+}
+
 std::vector<Fr> generateSystematicVector(int idx, int n)
 {
     std::vector<Fr> ret(n, 0);
@@ -170,33 +527,86 @@ std::vector<Fr> generateSystematicVector(int idx, int n)
     return ret;
 }
 
+void packElement(Fr &out, const uint8_t *bytes, int len)
+{
+    // the top byte stays zero, so the value is always below the group order
+    uint8_t buf[32] = {0};
+    std::copy(bytes, bytes + len, buf);
+    if (out.deserialize(buf, sizeof(buf)) == 0)
+    {
+        throw std::runtime_error("Could not pack bytes into a field element!");
+    }
+}
+
+void unpackElement(uint8_t *out, const Fr &x)
+{
+    uint8_t buf[32];
+    x.serialize(buf, sizeof(buf));
+    std::copy(buf, buf + PACKED_BYTES, out);
+}
+
+int PieceSizeFor(int dataLen, int pieceCount, bool packed)
+{
+    int elements = packed ? (dataLen + PACKED_BYTES - 1) / PACKED_BYTES : dataLen;
+    return (elements + pieceCount - 1) / pieceCount;
+}
+
 std::vector<std::vector<Fr>>
-OriginalPiecesWithCountAndSize(std::vector<uint8_t> data, int pieceCount, int pieceSize)
+OriginalPiecesWithCountAndSize(const uint8_t *data, size_t len, int pieceCount, int pieceSize, bool packed)
 {
-    data.resize(pieceSize * pieceCount, 0);
-    std::vector<std::vector<Fr>> ret(pieceCount, std::vector<Fr>(pieceSize));
-    for (int i = 0; i < pieceCount; i++)
+    std::vector<std::vector<Fr>> ret(pieceCount, std::vector<Fr>(pieceSize, 0));
+    int bytesPerElement = packed ? PACKED_BYTES : 1;
+    size_t offset = 0;
+    for (int i = 0; i < pieceCount && offset < len; i++)
     {
-        copy(data.begin() + i * pieceSize, data.begin() + (i + 1) * pieceSize,
-             ret[i].begin());
+        for (int j = 0; j < pieceSize && offset < len; j++)
+        {
+            int n = std::min<size_t>(bytesPerElement, len - offset);
+            if (packed)
+            {
+                packElement(ret[i][j], data + offset, n);
+            }
+            else
+            {
+                ret[i][j] = data[offset];
+            }
+            offset += n;
+        }
     }
     return ret;
 }
 
 std::vector<std::vector<Fr>>
-OriginalPiecesFromDataAndPieceCount(std::vector<uint8_t> data, int pieceCount)
+OriginalPiecesWithCountAndSize(const std::vector<uint8_t> &data, int pieceCount, int pieceSize, bool packed)
+{
+    return OriginalPiecesWithCountAndSize(data.data(), data.size(), pieceCount, pieceSize, packed);
+}
+
+std::vector<std::vector<Fr>>
+OriginalPiecesFromDataAndPieceCount(const std::vector<uint8_t> &data, int pieceCount, bool packed)
+{
+    return OriginalPiecesFromDataAndPieceCount(data.data(), data.size(), pieceCount, packed);
+}
+
+std::vector<std::vector<Fr>>
+OriginalPiecesFromDataAndPieceCount(const uint8_t *data, size_t len, int pieceCount, bool packed)
+{
+    int pieceSize = PieceSizeFor(len, pieceCount, packed);
+    return OriginalPiecesWithCountAndSize(data, len, pieceCount, pieceSize, packed);
+}
+
+std::vector<std::vector<Fr>>
+OriginalPiecesFromDataAndPieceSize(const std::vector<uint8_t> &data, int pieceSize, bool packed)
 {
-    int size = data.size();
-    int pieceSize = ceil((float)size / (float)pieceCount);
-    return OriginalPiecesWithCountAndSize(data, pieceCount, pieceSize);
+    return OriginalPiecesFromDataAndPieceSize(data.data(), data.size(), pieceSize, packed);
 }
 
 std::vector<std::vector<Fr>>
-OriginalPiecesFromDataAndPieceSize(std::vector<uint8_t> data, int pieceSize)
+OriginalPiecesFromDataAndPieceSize(const uint8_t *data, size_t len, int pieceSize, bool packed)
 {
-    int size = data.size();
-    int pieceCount = ceil((float)size / (float)pieceSize);
-    return OriginalPiecesWithCountAndSize(data, pieceCount, pieceSize);
+    int elements = packed ? (len + PACKED_BYTES - 1) / PACKED_BYTES : len;
+    int pieceCount = (elements + pieceSize - 1) / pieceSize;
+    return OriginalPiecesWithCountAndSize(data, len, pieceCount, pieceSize, packed);
 }
 
 std::string RandomString(int length)
@@ -4,7 +4,7 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <stdexcept>
-#include <vector>
+#include <algorithm>
 #include <boneh.hpp>
 #include <li.hpp>
 #include <zhang.hpp>
@@ -12,24 +12,28 @@
 #include <chang.hpp>
 
 template <typename T, typename S>
-FullRLNCDecoder<T, S>::FullRLNCDecoder(int pieceCount, T sig)
+FullRLNCDecoder<T, S>::FullRLNCDecoder(int pieceCount, T sig, bool packed, bool sparse)
 {
+    this->packed = packed;
     expected = pieceCount;
     useful = 0;
     received = 0;
     this->sig = sig;
-    state = DecoderState<S>(pieceCount);
+    state = DecoderState<S>(pieceCount, sparse);
 }
 
 template <typename T, typename S>
-FullRLNCDecoder<T, S>::FullRLNCDecoder(){};
+FullRLNCDecoder<T, S>::FullRLNCDecoder()
+{
+    packed = false;
+};
 
 template <typename T, typename S>
 int FullRLNCDecoder<T, S>::PieceLength()
 {
-    if (received > 0)
+    if (useful > 0)
     {
-        return state.CodedMatrix().cols;
+        return state.coded.cols;
     }
     return 0;
 }
@@ -41,21 +45,27 @@ template <typename T, typename S>
 int FullRLNCDecoder<T, S>::Required() { return expected - useful; }
 
 template <typename T, typename S>
-void FullRLNCDecoder<T, S>::addPiece(CodedPiece<S> piece)
+void FullRLNCDecoder<T, S>::addPiece(CodedPiece<S> &&piece) { addPiece(piece); }
+
+template <typename T, typename S>
+void FullRLNCDecoder<T, S>::addPiece(CodedPiece<S> &piece)
 {
-    if (IsDecoded() || !sig.Verify(piece))
+    if (IsDecoded())
     {
         return;
     }
-    state.AddPiece(piece);
-    received++;
-    if (received <= 1)
+    // redundant pieces are dropped before paying for the pairings
+    if (!state.IsInnovative(piece.codingVector()))
     {
-        useful++;
+        received++;
         return;
     }
-
-    state.Rref();
+    if (!sig.Verify(piece))
+    {
+        return;
+    }
+    state.AddPiece(piece);
+    received++;
     useful = state.Rank();
 }
 
@@ -64,32 +74,51 @@ std::vector<Fr> FullRLNCDecoder<T, S>::getPiece(int i) { return state.GetPiece(i
 
 template <typename T, typename S>
 std::vector<uint8_t> FullRLNCDecoder<T, S>::getData()
+{
+    std::vector<uint8_t> pieces((size_t)useful * PieceLength() * (packed ? PACKED_BYTES : 1));
+    writeData(pieces.data(), pieces.size());
+    int len = pieces.size() - 1;
+    while (pieces[len] == 0)
+    {
+        len--;
+    }
+    pieces.resize(len + 1);
+    return pieces;
+}
+
+template <typename T, typename S>
+std::vector<uint8_t> FullRLNCDecoder<T, S>::getData(size_t length)
+{
+    std::vector<uint8_t> pieces(length);
+    writeData(pieces.data(), length);
+    return pieces;
+}
+
+template <typename T, typename S>
+void FullRLNCDecoder<T, S>::writeData(uint8_t *out, size_t length)
 {
     if (!IsDecoded())
     {
         throw std::runtime_error("More useful pieces are required!");
     }
-    std::vector<uint8_t> pieces;
-    std::vector<Fr> tempPiece;
-    std::vector<uint8_t> tempVec;
-    std::string tempString;
-    for (int i = 0; i < useful; i++)
+    int bytesPerElement = packed ? PACKED_BYTES : 1;
+    if (length > (size_t)useful * PieceLength() * bytesPerElement)
     {
-        tempPiece = getPiece(i);
-        for (int j = 0; j < tempPiece.size(); j++)
-        {
-            tempString = tempPiece[j].getStr(mcl::IoSerialize);
-            tempVec = std::vector<uint8_t>(tempString.begin(), tempString.end());
-            pieces.push_back(tempVec[0]);
-        }
+        throw std::out_of_range("Decoded data is shorter than requested!");
     }
-    int len = pieces.size() - 1;
-    while (pieces[len] == 0)
+    uint8_t tempBytes[32];
+    size_t offset = 0;
+    for (int i = 0; i < useful && offset < length; i++)
     {
-        len--;
+        std::vector<Fr> tempPiece = getPiece(i);
+        for (int j = 0; j < tempPiece.size() && offset < length; j++)
+        {
+            tempPiece[j].serialize(tempBytes, sizeof(tempBytes));
+            size_t n = std::min<size_t>(bytesPerElement, length - offset);
+            std::copy(tempBytes, tempBytes + n, out + offset);
+            offset += n;
+        }
     }
-    pieces.resize(len + 1);
-    return pieces;
 }
 
 template class FullRLNCDecoder<Boneh, G1>;
@@ -10,212 +10,277 @@
 template <typename S>
 DecoderState<S>::DecoderState(Matrix cfs, Matrix pieces)
 {
-    coeffs = cfs;
-    coded = pieces;
-    pieceCount = cfs.rows;
+    if (cfs.rows != pieces.rows)
+    {
+        throw std::invalid_argument("Every coefficient row needs a coded row!");
+    }
+    pieceCount = cfs.cols;
+    sparse = false;
+    pivots.assign(cfs.cols, -1);
+    coeffs = Matrix(0, cfs.cols);
+    coded = Matrix(0, pieces.cols);
+    for (int i = 0; i < cfs.rows; i++)
+    {
+        dense_add(Span<const Fr>(cfs.Row(i), cfs.cols), Span<const Fr>(pieces.Row(i), pieces.cols));
+    }
 }
 
 template <typename S>
-DecoderState<S>::DecoderState(int p)
+DecoderState<S>::DecoderState(int p, bool sparse)
 {
     pieceCount = p;
-    Matrix cfs(std::vector<std::vector<Fr>>(1));
-    Matrix cd(std::vector<std::vector<Fr>>(1));
-    coeffs = cfs;
-    coded = cd;
+    this->sparse = sparse;
+    pivots.assign(p, -1);
+    coeffs = Matrix(0, sparse ? 0 : p);
+    coded = Matrix(0, 0);
 }
 
 template <typename S>
-DecoderState<S>::DecoderState(){};
+DecoderState<S>::DecoderState()
+{
+    pieceCount = 0;
+    sparse = false;
+};
 
-int min(int a, int b)
+template <typename S>
+void DecoderState<S>::dense_add(Span<const Fr> codingVector, Span<const Fr> piece)
 {
-    if (a <= b)
+    // both widths are checked first, so coeffs and coded never get out of step
+    if (codingVector.size() != coeffs.cols || piece.size() != coded.cols)
     {
-        return a;
+        throw std::invalid_argument("Row does not match the decoder matrices!");
     }
-    return b;
-}
+    coeffs.AppendRow(codingVector);
+    coded.AppendRow(piece);
+    int target = coeffs.rows - 1;
 
-template <typename S>
-void DecoderState<S>::clean_forward()
-{
-    int rows = coeffs.rows;
-    int cols = coeffs.cols;
-    int boundary = min(rows, cols);
-    for (int i = 0; i < boundary; i++)
+    // every pivot row is zero left of its pivot and in the other pivot
+    // columns, so one pass by increasing column clears all known pivots
+    int lead = -1;
+    for (int c = 0; c < coeffs.cols; c++)
     {
-        if (coeffs.data[i][i].isZero())
+        if (coeffs.At(target, c).isZero())
         {
-            int pivot = i + 1;
-            bool non_zero_col = false;
-            for (; pivot < rows; pivot++)
-            {
-                if (!coeffs.data[pivot][i].isZero())
-                {
-                    non_zero_col = true;
-                    break;
-                }
-            }
-
-            if (!non_zero_col)
-            {
-                continue;
-            }
-
-            {
-                std::vector<Fr> tmp = coeffs.data[i];
-                coeffs.data[i] = coeffs.data[pivot];
-                coeffs.data[pivot] = tmp;
-            }
-
-            {
-                std::vector<Fr> tmp = coded.data[i];
-                coded.data[i] = coded.data[pivot];
-                coded.data[pivot] = tmp;
-            }
+            continue;
         }
-
-        for (int j = i + 1; j < rows; j++)
+        int pivot = pivots[c];
+        if (pivot < 0)
         {
-            if (coeffs.data[j][i].isZero())
+            if (lead < 0)
             {
-                continue;
-            }
-            Fr quotient = coeffs.data[j][i] / coeffs.data[i][i];
-            for (int k = i; k < cols; k++)
-            {
-                coeffs.data[j][k] -= coeffs.data[i][k] * quotient;
+                lead = c;
             }
+            continue;
+        }
+        Fr quotient = coeffs.At(target, c);
+        coeffs.SubtractRow(target, pivot, quotient, c);
+        coded.SubtractRow(target, pivot, quotient);
+    }
+    if (lead < 0)
+    {
+        // not innovative
+        coeffs.RemoveRow(target);
+        coded.RemoveRow(target);
+        return;
+    }
 
-            for (int k = 0; k < coded.data[0].size(); k++)
-            {
-                coded.data[j][k] -= coded.data[i][k] * quotient;
-            }
+    if (!coeffs.At(target, lead).isOne())
+    {
+        Fr inv = 1;
+        inv = inv / coeffs.At(target, lead);
+        coeffs.At(target, lead) = 1;
+        coeffs.ScaleRow(target, inv, lead + 1);
+        coded.ScaleRow(target, inv);
+    }
+    // clear the new pivot column from the earlier rows
+    for (int i = 0; i < target; i++)
+    {
+        if (coeffs.At(i, lead).isZero())
+        {
+            continue;
         }
+        Fr quotient = coeffs.At(i, lead);
+        coeffs.SubtractRow(i, target, quotient, lead);
+        coded.SubtractRow(i, target, quotient);
     }
+    pivots[lead] = target;
 }
 
 template <typename S>
-void DecoderState<S>::clean_backward()
+void DecoderState<S>::sparse_forward(SparseRow &row, int target)
 {
-    int rows = coeffs.rows;
-    int cols = coeffs.cols;
-    int boundary = min(rows, cols);
-    for (int i = boundary - 1; i >= 0; i--)
+    // eliminate known pivots by increasing column; the rows subtracted only
+    // have entries right of their pivot, so the scan never moves back
+    int idx = 0;
+    while (idx < row.cols.size())
     {
-        if (coeffs.data[i][i].isZero())
+        int pivot = pivots[row.cols[idx]];
+        if (pivot < 0)
         {
+            idx++;
             continue;
         }
+        Fr quotient = row.values[idx];
+        row.SubtractMultiple(sparseCoeffs[pivot], quotient);
+        coded.SubtractRow(target, pivot, quotient);
+    }
+}
 
-        for (int j = 0; j < i; j++)
+template <typename S>
+void DecoderState<S>::sparse_backward()
+{
+    for (int c = pieceCount - 1; c >= 0; c--)
+    {
+        int pivot = pivots[c];
+        SparseRow &row = sparseCoeffs[pivot];
+        for (int i = 1; i < row.cols.size(); i++)
         {
-            if (coeffs.data[j][i].isZero())
-            {
-                continue;
-            }
+            coded.SubtractRow(pivot, pivots[row.cols[i]], row.values[i]);
+        }
+        row.cols.resize(1);
+        row.values.resize(1);
+    }
+}
 
-            Fr quotient = coeffs.data[j][i] / coeffs.data[i][i];
-            for (int k = i; k < cols; k++)
-            {
-                coeffs.data[j][k] -= coeffs.data[i][k] * quotient;
-            }
+template <typename S>
+void DecoderState<S>::Rref()
+{
+    // the dense state is always reduced
+    if (sparse && Rank() == pieceCount)
+    {
+        sparse_backward();
+    }
+}
 
-            for (int k = 0; k < coded.data[0].size(); k++)
-            {
-                coded.data[j][k] -= coded.data[i][k] * quotient;
-            }
-        }
+template <typename S>
+int DecoderState<S>::Rank() { return sparse ? sparseCoeffs.size() : coeffs.rows; }
 
-        if (coeffs.data[i][i].isOne())
+template <typename S>
+Matrix DecoderState<S>::CoeffMatrix()
+{
+    Matrix ret(0, pivots.size());
+    for (int c = 0; c < pivots.size(); c++)
+    {
+        if (pivots[c] < 0)
         {
             continue;
         }
-
-        Fr inv = 1;
-        inv = inv / coeffs.data[i][i];
-        coeffs.data[i][i] = 1;
-        for (int j = i + 1; j < cols; j++)
+        if (sparse)
         {
-            if (coeffs.data[i][j].isZero())
-            {
-                continue;
-            }
-
-            coeffs.data[i][j] *= inv;
+            ret.AppendRow(sparseCoeffs[pivots[c]].Dense(pieceCount));
         }
-
-        for (int j = 0; j < coded.data[0].size(); j++)
+        else
         {
-            coded.data[i][j] *= inv;
+            ret.AppendRow(Span<const Fr>(coeffs.Row(pivots[c]), coeffs.cols));
         }
     }
+    return ret;
 }
 
 template <typename S>
-void DecoderState<S>::remove_zero_rows()
+Matrix DecoderState<S>::CodedMatrix()
 {
-    int cols = coeffs.data[0].size();
-    for (int i = 0; i < coeffs.data.size(); i++)
+    Matrix ret(0, coded.cols);
+    for (int c = 0; c < pivots.size(); c++)
     {
-        bool yes = true;
-        for (int j = 0; j < cols; j++)
+        if (pivots[c] >= 0)
         {
-            if (!coeffs.data[i][j].isZero())
-            {
-                yes = false;
-                break;
-            }
+            ret.AppendRow(coded.GetRow(pivots[c]));
         }
-        if (!yes)
-        {
-            continue;
-        }
-
-        coeffs.data.erase(coeffs.data.begin() + i);
-        coeffs.rows--;
-        coded.data.erase(coded.data.begin() + i);
-        coded.rows--;
-
-        i--;
     }
+    return ret;
 }
 
 template <typename S>
-void DecoderState<S>::Rref()
+void DecoderState<S>::AddPiece(CodedPiece<S> &a)
 {
-    clean_forward();
-    clean_backward();
-    remove_zero_rows();
+    // checked up front, so a bad piece leaves the state untouched
+    if (a.dataLen() - a.pieceSize != pieceCount)
+    {
+        throw std::invalid_argument("Coding vector does not match the piece count!");
+    }
+    if (Rank() > 0 && a.pieceSize != coded.cols)
+    {
+        throw std::invalid_argument("Piece size does not match the received pieces!");
+    }
+    if (sparse)
+    {
+        // the payload is reduced in place as the newest row of coded
+        if (Rank() == 0)
+        {
+            coded = Matrix(0, a.pieceSize);
+        }
+        coded.AppendRow(a.piece());
+        int target = coded.rows - 1;
+        SparseRow row(a.codingVector());
+        sparse_forward(row, target);
+        if (row.Empty())
+        {
+            coded.RemoveRow(target);
+            return;
+        }
+        // normalize so that the leading entry is one
+        Fr inv = 1;
+        inv = inv / row.values[0];
+        row.Scale(inv);
+        coded.ScaleRow(target, inv);
+        pivots[row.cols[0]] = sparseCoeffs.size();
+        sparseCoeffs.push_back(row);
+        Rref();
+        return;
+    }
+    if (Rank() == 0)
+    {
+        coded = Matrix(0, a.pieceSize);
+    }
+    dense_add(a.codingVector(), a.piece());
 }
 
 template <typename S>
-int DecoderState<S>::Rank() { return coeffs.rows; }
-
-template <typename S>
-Matrix DecoderState<S>::CoeffMatrix() { return coeffs; }
-
-template <typename S>
-Matrix DecoderState<S>::CodedMatrix() { return coded; }
-
-template <typename S>
-void DecoderState<S>::AddPiece(CodedPiece<S> a)
+bool DecoderState<S>::IsInnovative(Span<const Fr> codingVector)
 {
-    if (coeffs.cols == 0)
+    if (codingVector.size() != pivots.size())
     {
-        coeffs.data[0] = a.codingVector;
-        coded.data[0] = a.piece;
-        coeffs.cols = a.codingVector.size();
-        coded.cols = a.piece.size();
+        return true;
     }
-    else
+    // the first nonzero entry left in a column without a pivot cannot be
+    // cleared by the pivot rows that follow, as they are zero left of their
+    // pivot
+    if (sparse)
+    {
+        SparseRow row(codingVector);
+        while (!row.Empty())
+        {
+            int pivot = pivots[row.cols[0]];
+            if (pivot < 0)
+            {
+                return true;
+            }
+            Fr quotient = row.values[0];
+            row.SubtractMultiple(sparseCoeffs[pivot], quotient);
+        }
+        return false;
+    }
+    probe.assign(codingVector.begin(), codingVector.end());
+    for (int c = 0; c < probe.size(); c++)
     {
-        coeffs.data.push_back(a.codingVector);
-        coded.data.push_back(a.piece);
-        coeffs.rows++;
-        coded.rows++;
+        if (probe[c].isZero())
+        {
+            continue;
+        }
+        int pivot = pivots[c];
+        if (pivot < 0)
+        {
+            return true;
+        }
+        const Fr *row = coeffs.Row(pivot);
+        Fr quotient = probe[c];
+        for (int j = c; j < probe.size(); j++)
+        {
+            probe[j] -= row[j] * quotient;
+        }
     }
+    return false;
 }
 
 template <typename S>
@@ -225,39 +290,30 @@ std::vector<Fr> DecoderState<S>::GetPiece(int idx)
     {
         throw std::out_of_range("Index out of bounds");
     }
-    if (idx >= coeffs.rows)
+    int pivot = pivots[idx];
+    if (pivot < 0)
     {
         throw std::runtime_error("Piece not yet decoded");
     }
-    if (Rank() >= pieceCount)
+    // a pivot row holds an original piece once no other column is left in it
+    bool decoded;
+    if (sparse)
     {
-        return coded.data[idx];
+        decoded = sparseCoeffs[pivot].cols.size() == 1;
     }
-    bool decoded = true;
-    for (int i = 0; i < coeffs.cols; i++)
+    else
     {
-        switch (i)
+        decoded = true;
+        for (int c = 0; c < coeffs.cols && decoded; c++)
         {
-        case 0:
-            if (!coeffs.data[idx][i].isOne())
-            {
-                decoded = false;
-                goto OUT;
-            }
-        default:
-            if (coeffs.data[idx][i].isZero())
-            {
-                decoded = false;
-                goto OUT;
-            }
+            decoded = c == idx || coeffs.At(pivot, c).isZero();
         }
     }
-OUT:
     if (!decoded)
     {
         throw std::runtime_error("Piece not yet decoded");
     }
-    return coded.data[idx];
+    return coded.GetRow(pivot);
 }
 
 template class DecoderState<G1>;
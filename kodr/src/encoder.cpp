@@ -3,6 +3,8 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <string>
+#include <algorithm>
+#include <stdexcept>
 #include <boneh.hpp>
 #include <li.hpp>
 #include <zhang.hpp>
@@ -16,27 +18,48 @@ FullRLNCEncoder<T, S>::FullRLNCEncoder(std::vector<std::vector<Fr>> pieces, T si
     this->pieces = pieces;
     this->useSystematic = generateSystematic;
     this->pieceIndex = 0;
+    this->deriveSignatures = false;
+    this->seedCodingVectors = false;
+    this->coefficientBits = 0;
+    this->density = 1;
 }
 
 template <typename T, typename S>
-FullRLNCEncoder<T, S>::FullRLNCEncoder(std::vector<uint8_t> data,
-                                 int pieceCountOrSize, T sig, bool generateSystematic, bool fromSize)
+FullRLNCEncoder<T, S>::FullRLNCEncoder(const std::vector<uint8_t> &data,
+                                 int pieceCountOrSize, T sig, bool generateSystematic, bool fromSize, bool packed)
+    : FullRLNCEncoder(data.data(), data.size(), pieceCountOrSize, sig, generateSystematic, fromSize, packed)
+{
+}
+
+template <typename T, typename S>
+FullRLNCEncoder<T, S>::FullRLNCEncoder(const uint8_t *data, size_t len,
+                                 int pieceCountOrSize, T sig, bool generateSystematic, bool fromSize, bool packed)
 {
     this->sig = sig;
     this->useSystematic = generateSystematic;
     this->pieceIndex = 0;
+    this->deriveSignatures = false;
+    this->seedCodingVectors = false;
+    this->coefficientBits = 0;
+    this->density = 1;
     if (fromSize)
     {
-        this->pieces = OriginalPiecesFromDataAndPieceSize(data, pieceCountOrSize);
+        this->pieces = OriginalPiecesFromDataAndPieceSize(data, len, pieceCountOrSize, packed);
     }
     else
     {
-        this->pieces = OriginalPiecesFromDataAndPieceCount(data, pieceCountOrSize);
+        this->pieces = OriginalPiecesFromDataAndPieceCount(data, len, pieceCountOrSize, packed);
     }
 }
 
 template <typename T, typename S>
-FullRLNCEncoder<T, S>::FullRLNCEncoder(){};
+FullRLNCEncoder<T, S>::FullRLNCEncoder()
+{
+    this->deriveSignatures = false;
+    this->seedCodingVectors = false;
+    this->coefficientBits = 0;
+    this->density = 1;
+};
 
 template <typename T, typename S>int 
 FullRLNCEncoder<T, S>::PieceCount() { return pieces.size(); }
@@ -54,25 +77,195 @@ template <typename T, typename S> CodedPiece<S>
 FullRLNCEncoder<T, S>::getCodedPiece()
 {
     std::vector<Fr> codingVec;
-    std::vector<Fr> piece;
-    S signature;
+    if (deriveSignatures && baseSignatures.empty())
+    {
+        signOriginals();
+    }
+    // the payload is built in place in the buffer of the returned piece
+    CodedPiece<S> coded(std::vector<Fr>(PieceSize() + PieceCount(), 0), PieceSize(), S());
+    Span<Fr> piece = coded.piece();
     if (useSystematic && pieceIndex < PieceCount())
     {
-        codingVec = generateSystematicVector(pieceIndex, PieceCount());
-        piece = pieces[pieceIndex];
+        std::copy(pieces[pieceIndex].begin(), pieces[pieceIndex].end(), piece.begin());
+        coded.codingVector()[pieceIndex] = 1;
+        if (deriveSignatures)
+        {
+            coded.signature = baseSignatures[pieceIndex++];
+            return coded;
+        }
         pieceIndex++;
     }
     else
     {
-        codingVec = generateCodingVector(PieceCount());
-        piece = std::vector<Fr>(PieceSize(), 0);
+        std::vector<uint32_t> words;
+        drawCodingVector(codingVec, words, coded.seeded, coded.seed);
+        std::copy(codingVec.begin(), codingVec.end(), coded.codingVector().begin());
         for (int i = 0; i < PieceCount(); i++)
         {
-            piece = multiply(piece, pieces[i], codingVec[i]);
+            if (codingVec[i].isZero())
+            {
+                continue;
+            }
+            if (coefficientBits > 0)
+            {
+                multiplyAddShort(piece, pieces[i], words[i]);
+            }
+            else
+            {
+                multiplyAdd(piece, pieces[i], codingVec[i]);
+            }
+        }
+    }
+    if (deriveSignatures)
+    {
+        coded.signature = sig.Combine(baseSignatures, coded.codingVector());
+    }
+    else
+    {
+        coded.signature = sig.Sign(coded.piece(), coded.codingVector());
+    }
+    return coded;
+}
+
+template <typename T, typename S>
+void FullRLNCEncoder<T, S>::drawCodingVector(std::vector<Fr> &codingVec, std::vector<uint32_t> &words, bool &seeded, uint64_t &seed)
+{
+    int n = PieceCount();
+    seeded = false;
+    if (coefficientBits > 0)
+    {
+        words = generateShortCoefficients(n, coefficientBits);
+        if (density < 1)
+        {
+            std::vector<uint32_t> kept(n, 0);
+            std::vector<int> support = sparseSupport(n, density);
+            for (int i = 0; i < support.size(); i++)
+            {
+                kept[support[i]] = words[support[i]];
+            }
+            words.swap(kept);
+        }
+        codingVec = shortToField(words);
+    }
+    else if (density < 1)
+    {
+        codingVec = generateSparseCodingVector(n, density);
+    }
+    else if (seedCodingVectors)
+    {
+        seeded = true;
+        seed = generateSeed();
+        codingVec = expandCodingVector(seed, n);
+    }
+    else
+    {
+        codingVec = generateCodingVector(n);
+    }
+}
+
+const int ROW_BLOCK = 8;
+const int COL_BLOCK = 256;
+
+// out[r].piece() = sum_i out[r].codingVector()[i] * pieces[i] for rows in
+// [rowBegin, rowEnd), one COL_BLOCK wide strip at a time so the strip of
+// every original piece is reused from cache by all rows of the block.
+// shortCoeffs, when given, holds the same coefficients as machine words.
+template <typename S>
+void combineRows(std::vector<CodedPiece<S>> &out, std::vector<std::vector<Fr>> &pieces,
+                 const std::vector<std::vector<uint32_t>> *shortCoeffs, int rowBegin, int rowEnd)
+{
+    int cols = pieces[0].size();
+    Fr t;
+    for (int c0 = 0; c0 < cols; c0 += COL_BLOCK)
+    {
+        int c1 = std::min(c0 + COL_BLOCK, cols);
+        for (int i = 0; i < pieces.size(); i++)
+        {
+            const Fr *src = pieces[i].data();
+            for (int r = rowBegin; r < rowEnd; r++)
+            {
+                const Fr &by = out[r].codingVector()[i];
+                if (by.isZero())
+                {
+                    continue;
+                }
+                Fr *dst = out[r].piece().data();
+                if (shortCoeffs)
+                {
+                    uint32_t word = (*shortCoeffs)[r][i];
+                    for (int c = c0; c < c1; c++)
+                    {
+                        Fr::mulUnit(t, src[c], word);
+                        Fr::add(dst[c], dst[c], t);
+                    }
+                    continue;
+                }
+                for (int c = c0; c < c1; c++)
+                {
+                    Fr::mul(t, src[c], by);
+                    Fr::add(dst[c], dst[c], t);
+                }
+            }
+        }
+    }
+}
+
+template <typename T, typename S>
+std::vector<CodedPiece<S>> FullRLNCEncoder<T, S>::getCodedPieces(int n, std::shared_ptr<ThreadPool> pool)
+{
+    if (!pool)
+    {
+        pool = ThreadPool::Shared();
+    }
+    if (deriveSignatures && baseSignatures.empty())
+    {
+        signOriginals(pool);
+    }
+    std::vector<CodedPiece<S>> batch(n);
+    std::vector<std::vector<uint32_t>> shortCoeffs(coefficientBits > 0 ? n : 0);
+    int firstSystematic = pieceIndex;
+    int systematic = 0;
+    for (int r = 0; r < n; r++)
+    {
+        batch[r].buffer.assign(PieceSize() + PieceCount(), 0);
+        batch[r].pieceSize = PieceSize();
+        if (useSystematic && pieceIndex < PieceCount())
+        {
+            std::copy(pieces[pieceIndex].begin(), pieces[pieceIndex].end(), batch[r].piece().begin());
+            batch[r].codingVector()[pieceIndex] = 1;
+            pieceIndex++;
+            systematic++;
         }
+        else
+        {
+            std::vector<Fr> codingVec;
+            std::vector<uint32_t> words;
+            drawCodingVector(codingVec, coefficientBits > 0 ? shortCoeffs[r] : words,
+                             batch[r].seeded, batch[r].seed);
+            std::copy(codingVec.begin(), codingVec.end(), batch[r].codingVector().begin());
+        }
+    }
+
+    int blocks = (n - systematic + ROW_BLOCK - 1) / ROW_BLOCK;
+    pool->ParallelFor(blocks, [&](int b)
+                      { combineRows(batch, pieces, coefficientBits > 0 ? &shortCoeffs : nullptr, systematic + b * ROW_BLOCK, std::min(systematic + (b + 1) * ROW_BLOCK, n)); });
+    if (!deriveSignatures)
+    {
+        pool->ParallelFor(n, [&](int r)
+                          { batch[r].signature = sig.Sign(batch[r].piece(), batch[r].codingVector()); });
+        return batch;
     }
-    signature = sig.Sign(piece, codingVec);
-    return CodedPiece<S>(piece, codingVec, signature);;
+    for (int r = 0; r < systematic; r++)
+    {
+        batch[r].signature = baseSignatures[firstSystematic + r];
+    }
+    // each task combines its own copy, as the multi-exponentiation may
+    // normalize the points it is given
+    pool->ParallelFor(n - systematic, [&](int r)
+                      {
+                          std::vector<S> signs = baseSignatures;
+                          batch[systematic + r].signature = sig.Combine(signs, batch[systematic + r].codingVector()); });
+    return batch;
 }
 
 template <typename T, typename S>
@@ -80,6 +273,59 @@ void FullRLNCEncoder<T, S>::setPieces(std::vector<std::vector<Fr>> pieces)
 {
     this->pieces = pieces;
     this->pieceIndex = 0;
+    this->baseSignatures.clear();
+}
+
+template <typename T, typename S>
+void FullRLNCEncoder<T, S>::setDeriveSignatures(bool derive)
+{
+    this->deriveSignatures = derive;
+}
+
+template <typename T, typename S>
+void FullRLNCEncoder<T, S>::setSeedCodingVectors(bool seeded)
+{
+    this->seedCodingVectors = seeded;
+}
+
+template <typename T, typename S>
+void FullRLNCEncoder<T, S>::setShortCoefficients(int bits)
+{
+    if (bits < 0 || bits > 32)
+    {
+        throw std::invalid_argument("Short coefficients must have 1 to 32 bits!");
+    }
+    this->coefficientBits = bits;
+}
+
+template <typename T, typename S>
+void FullRLNCEncoder<T, S>::setDensity(double density)
+{
+    if (density <= 0 || density > 1)
+    {
+        throw std::invalid_argument("Density must be in (0, 1]!");
+    }
+    this->density = density;
+}
+
+template <typename T, typename S>
+double FullRLNCEncoder<T, S>::NonInnovativeProbability()
+{
+    return (1 - density) + density * ::NonInnovativeProbability(coefficientBits);
+}
+
+template <typename T, typename S>
+void FullRLNCEncoder<T, S>::signOriginals(std::shared_ptr<ThreadPool> pool)
+{
+    if (!pool)
+    {
+        pool = ThreadPool::Shared();
+    }
+    baseSignatures.resize(PieceCount());
+    pool->ParallelFor(PieceCount(), [&](int i)
+                      {
+                          std::vector<Fr> codingVec = generateSystematicVector(i, PieceCount());
+                          baseSignatures[i] = sig.Sign(pieces[i], codingVec); });
 }
 
 template class FullRLNCEncoder<Boneh, G1>;
@@ -0,0 +1,219 @@
+#include <identity_registry.hpp>
+#include <data.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+#include <li.hpp>
+#include <zhang.hpp>
+
+template <typename T>
+IdentityRegistry<T>::IdentityRegistry(T authority, size_t memoryBudget)
+{
+    this->authority = authority;
+    this->memoryBudget = memoryBudget;
+    this->memoryUsed = 0;
+}
+
+template <typename T>
+std::shared_ptr<T> IdentityRegistry<T>::Sender(const std::string &nodeID, const G2 &nodeKey)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    typename std::unordered_map<std::string, Entry>::iterator it = entries.find(nodeID);
+    if (it != entries.end() && it->second.verifier->NodeKey() == nodeKey)
+    {
+        recency.splice(recency.begin(), recency, it->second.position);
+        return it->second.verifier;
+    }
+    if (it != entries.end())
+    {
+        return std::make_shared<T>(authority.ForSender(nodeID, nodeKey));
+    }
+
+    Entry entry;
+    entry.verifier = std::make_shared<T>(authority.ForSender(nodeID, nodeKey));
+    entry.footprint = entry.verifier->MemoryFootprint();
+    recency.push_front(nodeID);
+    entry.position = recency.begin();
+    memoryUsed += entry.footprint;
+    std::shared_ptr<T> verifier = entry.verifier;
+    entries[nodeID] = entry;
+    evict();
+    return verifier;
+}
+
+// Makes verifier the cached sender for nodeID, e.g. after the node was
+// issued a new key and a piece under it verified.
+template <typename T>
+void IdentityRegistry<T>::adopt(const std::string &nodeID, std::shared_ptr<T> verifier)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    typename std::unordered_map<std::string, Entry>::iterator it = entries.find(nodeID);
+    if (it != entries.end())
+    {
+        if (it->second.verifier == verifier)
+        {
+            return;
+        }
+        memoryUsed -= it->second.footprint;
+        recency.erase(it->second.position);
+        entries.erase(it);
+    }
+    Entry entry;
+    entry.verifier = verifier;
+    entry.footprint = verifier->MemoryFootprint();
+    recency.push_front(nodeID);
+    entry.position = recency.begin();
+    memoryUsed += entry.footprint;
+    entries[nodeID] = entry;
+    evict();
+}
+
+template <typename T>
+bool IdentityRegistry<T>::cachedKey(const std::string &nodeID, G2 &key)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    typename std::unordered_map<std::string, Entry>::iterator it = entries.find(nodeID);
+    if (it == entries.end())
+    {
+        return false;
+    }
+    key = it->second.verifier->NodeKey();
+    return true;
+}
+
+// Position tables fill lazily during verification, so the footprint of a
+// sender is refreshed after every use.
+template <typename T>
+void IdentityRegistry<T>::update(const std::string &nodeID)
+{
+    std::lock_guard<std::mutex> guard(lock);
+    typename std::unordered_map<std::string, Entry>::iterator it = entries.find(nodeID);
+    if (it == entries.end())
+    {
+        return;
+    }
+    size_t footprint = it->second.verifier->MemoryFootprint();
+    memoryUsed = memoryUsed - it->second.footprint + footprint;
+    it->second.footprint = footprint;
+    evict();
+}
+
+// Keeps the most recently used sender even if it alone exceeds the budget.
+template <typename T>
+void IdentityRegistry<T>::evict()
+{
+    while (memoryUsed > memoryBudget && recency.size() > 1)
+    {
+        typename std::unordered_map<std::string, Entry>::iterator it = entries.find(recency.back());
+        memoryUsed -= it->second.footprint;
+        entries.erase(it);
+        recency.pop_back();
+    }
+}
+
+template <typename T>
+bool IdentityRegistry<T>::Verify(const std::string &nodeID, const G2 &nodeKey, CodedPiece<G1> &piece)
+{
+    std::shared_ptr<T> sender = Sender(nodeID, nodeKey);
+    bool valid = sender->Verify(piece);
+    if (valid)
+    {
+        adopt(nodeID, sender);
+    }
+    update(nodeID);
+    return valid;
+}
+
+template <typename T>
+std::vector<bool> IdentityRegistry<T>::VerifyBatch(const std::string &nodeID, const G2 &nodeKey, std::vector<CodedPiece<G1>> &pieces)
+{
+    std::shared_ptr<T> sender = Sender(nodeID, nodeKey);
+    std::vector<bool> valid = sender->VerifyBatch(pieces);
+    if (std::find(valid.begin(), valid.end(), true) != valid.end())
+    {
+        adopt(nodeID, sender);
+    }
+    update(nodeID);
+    return valid;
+}
+
+template <typename T>
+std::vector<bool> IdentityRegistry<T>::VerifyGrouped(std::vector<std::string> &nodeIDs, std::vector<G2> &nodeKeys, std::vector<CodedPiece<G1>> &pieces)
+{
+    if (nodeIDs.size() != pieces.size() || nodeKeys.size() != pieces.size())
+    {
+        throw std::invalid_argument("Every piece needs a sender!");
+    }
+    std::unordered_map<std::string, std::vector<int>> groups;
+    std::vector<std::string> order;
+    for (int i = 0; i < pieces.size(); i++)
+    {
+        std::vector<int> &group = groups[nodeIDs[i]];
+        if (group.empty())
+        {
+            order.push_back(nodeIDs[i]);
+        }
+        group.push_back(i);
+    }
+
+    std::vector<bool> valid(pieces.size(), false);
+    for (int g = 0; g < order.size(); g++)
+    {
+        std::vector<int> &group = groups[order[g]];
+        // batch under the cached key when some piece claims it, so that odd
+        // pieces cannot displace it
+        G2 key = nodeKeys[group[0]];
+        G2 cached;
+        if (cachedKey(order[g], cached))
+        {
+            for (int i = 0; i < group.size(); i++)
+            {
+                if (nodeKeys[group[i]] == cached)
+                {
+                    key = cached;
+                    break;
+                }
+            }
+        }
+        std::vector<CodedPiece<G1>> batch;
+        std::vector<int> members;
+        for (int i = 0; i < group.size(); i++)
+        {
+            // a piece claiming a different key than the rest of its group is checked alone
+            if (nodeKeys[group[i]] == key)
+            {
+                batch.push_back(pieces[group[i]]);
+                members.push_back(group[i]);
+            }
+            else
+            {
+                valid[group[i]] = Verify(order[g], nodeKeys[group[i]], pieces[group[i]]);
+            }
+        }
+        std::vector<bool> result = VerifyBatch(order[g], key, batch);
+        for (int i = 0; i < members.size(); i++)
+        {
+            valid[members[i]] = result[i];
+        }
+    }
+    return valid;
+}
+
+template <typename T>
+int IdentityRegistry<T>::Size()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+template <typename T>
+size_t IdentityRegistry<T>::MemoryUsed()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return memoryUsed;
+}
+
+template class IdentityRegistry<Li>;
+template class IdentityRegistry<Zhang>;
\ No newline at end of file
@@ -1,8 +1,12 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <li.hpp>
+#include <batch.hpp>
+#include <workspace.hpp>
+#include <msm.hpp>
 #include <random>
 #include <assert.h>
+#include <stdexcept>
 
 Li::Li(std::string nodeID, std::string fileName)
 {
@@ -15,7 +19,10 @@ Li::Li(std::string nodeID, std::string fileName)
     r.setRand();
     big_r = h * r;
     nodeIDBytes = std::vector<uint8_t>(nodeID.begin(), nodeID.end());
-    sk = r + s * h0(nodeIDBytes, big_r);
+    Fr idDigest = h0(nodeIDBytes, big_r);
+    sk = r + s * idDigest;
+    hLines = PrecomputedG2(h);
+    keyLines = PrecomputedG2(big_r + (mpk * idDigest));
     assert(verifyPrivateKey());
 }
 
@@ -24,36 +31,32 @@ Li::Li(){};
 Fr Li::h0(std::vector<uint8_t> &inputBytes, G2 &element)
 {
     Fr result;
-    std::string tmp = element.getStr(mcl::IoSerialize);
-    std::vector<uint8_t> tmpBytes(tmp.begin(), tmp.end());
-    std::vector<uint8_t> inputBytesWithElement(inputBytes.size() + tmpBytes.size());
-    std::copy(inputBytes.begin(), inputBytes.end(), inputBytesWithElement.begin());
-    std::copy(tmpBytes.begin(), tmpBytes.end(), inputBytesWithElement.begin() + inputBytes.size());
-    result.setHashOf(inputBytesWithElement.data(), inputBytesWithElement.size());
+    std::vector<uint8_t> &buf = LocalWorkspace().hashInput;
+    buf.assign(inputBytes.begin(), inputBytes.end());
+    appendPoint(buf, element);
+    result.setHashOf(buf.data(), buf.size());
     return result;
 }
 
 G1 Li::h1(std::vector<uint8_t> &inputBytes, uint8_t &index)
 {
     G1 result;
-    std::vector<uint8_t> inputBytesWithIndex(inputBytes.size() + 1);
-    std::copy(inputBytes.begin(), inputBytes.end(), inputBytesWithIndex.begin());
-    inputBytesWithIndex[inputBytes.size()] = index;
-    hashAndMapToG1(result, inputBytesWithIndex.data(), inputBytesWithIndex.size());
+    std::vector<uint8_t> &buf = LocalWorkspace().hashInput;
+    buf.assign(inputBytes.begin(), inputBytes.end());
+    buf.push_back(index);
+    hashAndMapToG1(result, buf.data(), buf.size());
     return result;
 }
 
 Fr Li::h2(std::vector<uint8_t> &inputBytes, uint8_t &index, std::vector<uint8_t> &extraBytes, G2 &element)
 {
     Fr result;
-    std::string tmp = element.getStr(mcl::IoSerialize);
-    std::vector<uint8_t> tmpBytes(tmp.begin(), tmp.end());
-    std::vector<uint8_t> combined(inputBytes.size() + 1 + extraBytes.size() + tmpBytes.size());
-    std::copy(inputBytes.begin(), inputBytes.end(), combined.begin());
-    combined[inputBytes.size()] = index;
-    std::copy(extraBytes.begin(), extraBytes.end(), combined.begin() + inputBytes.size() + 1);
-    std::copy(tmpBytes.begin(), tmpBytes.end(), combined.begin() + inputBytes.size() + 1 + extraBytes.size());
-    result.setHashOf(combined.data(), combined.size());
+    std::vector<uint8_t> &buf = LocalWorkspace().hashInput;
+    buf.assign(inputBytes.begin(), inputBytes.end());
+    buf.push_back(index);
+    buf.insert(buf.end(), extraBytes.begin(), extraBytes.end());
+    appendPoint(buf, element);
+    result.setHashOf(buf.data(), buf.size());
     return result;
 }
 
@@ -61,35 +64,51 @@ bool Li::verifyPrivateKey()
 {
     Fp12 e1, e2;
     G1 tmp1 = g * sk;
-    G2 tmp2 = big_r + (mpk * h0(nodeIDBytes, big_r));
     pairing(e1, tmp1, h);
-    pairing(e2, g, tmp2);
+    pairing(e2, g, keyLines.point);
     return e1 == e2;
 }
 
-G1 Li::AggregateHash(std::vector<Fr> &vec, std::vector<Fr> &codingVec)
+G1 Li::AggregateHash(Span<const Fr> vec, Span<const Fr> codingVec)
 {
     G1 result;
-    mapToG1(result, 1);
-    std::vector<Fr> fullVec(vec.size() + codingVec.size());
-    std::copy(vec.begin(), vec.end(), fullVec.begin());
-    std::copy(codingVec.begin(), codingVec.end(), fullVec.begin() + vec.size());
-    std::vector<G1> g1Hashes(codingVec.size());
-    for(uint8_t i = 0; i < g1Hashes.size(); i++)
+    // entry i of the concatenation vec || codingVec
+    auto full = [&](int i) -> const Fr &
+    { return i < vec.size() ? vec[i] : codingVec[i - vec.size()]; };
+    Workspace &ws = LocalWorkspace();
+    std::vector<int> &indices = ws.indices;
+    indices.clear();
+    for (int i = 0; i < codingVec.size(); i++)
     {
-        g1Hashes[i] = h1(fileIDBytes, i);
+        if (!full(i).isZero())
+        {
+            indices.push_back(i);
+        }
     }
-    G1::mulVec(result, g1Hashes.data(), fullVec.data(), g1Hashes.size());
+    std::shared_ptr<const std::vector<G1>> hashes = indexPoints.GetSome(indices, [this](G1 &P, int i)
+                                                                        { uint8_t index = i; P = h1(fileIDBytes, index); });
+    MSMTerms &terms = ws.terms;
+    terms.Clear();
+    for (int i = 0; i < indices.size(); i++)
+    {
+        terms.Add((*hashes)[indices[i]], full(indices[i]));
+    }
+    terms.Eval(result);
+    std::shared_ptr<const std::vector<Fr>> scalars = positionScalars.Get(vec.size(), [this](Fr &x, int j)
+                                                                         { uint8_t index = j; x = h2(nodeIDBytes, index, fileIDBytes, big_r); });
     Fr msgExp = 0;
-    for(uint8_t j = 0; j < vec.size(); j++)
+    for (int j = 0; j < vec.size(); j++)
     {
-        msgExp += h2(nodeIDBytes, j, fileIDBytes, big_r) * fullVec[j];
+        if (!vec[j].isZero())
+        {
+            msgExp += (*scalars)[j] * vec[j];
+        }
     }
     result += g * msgExp;
     return result;
 }
 
-G1 Li::Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec)
+G1 Li::Sign(Span<const Fr> vec, Span<const Fr> codingVec)
 {
     
     G1 sig = AggregateHash(vec, codingVec);
@@ -97,19 +116,59 @@ G1 Li::Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec)
     return sig;
 }
 
-G1 Li::Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs)
+G1 Li::Combine(std::vector<G1> &signs, Span<const Fr> coeffs)
 {
     G1 sig;
-    G1::mulVec(sig, signs.data(), coeffs.data(), signs.size());
+    MultiExp(sig, signs.data(), coeffs.data(), signs.size());
     return sig;
 };
 
 bool Li::Verify(CodedPiece<G1> &codedPiece)
 {
-    Fp12 e1, e2;
-    pairing(e1, codedPiece.signature, h);
-    G2 tmp = big_r + (mpk * h0(nodeIDBytes, big_r));
-    G1 hashed = AggregateHash(codedPiece.piece, codedPiece.codingVector);
-    pairing(e2, hashed, tmp);
-    return e1 == e2;
+    G1 hashed = AggregateHash(codedPiece.piece(), codedPiece.codingVector());
+    return PairingsEqual(codedPiece.signature, hLines, hashed, keyLines);
+}
+
+std::vector<bool> Li::VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces)
+{
+    return BatchVerify(*this, encodedPieces);
+}
+
+Li Li::Extract(std::string nodeID)
+{
+    if (s.isZero())
+    {
+        throw std::runtime_error("Only the master key holder can extract keys!");
+    }
+    // built from the public parameters, so the master secret stays here
+    Fr r;
+    r.setRand();
+    Li node = ForSender(nodeID, h * r);
+    node.sk = r + s * h0(node.nodeIDBytes, node.big_r);
+    return node;
+}
+
+Li Li::ForSender(std::string nodeID, G2 nodeKey)
+{
+    Li sender;
+    sender.s.clear();
+    sender.sk.clear();
+    sender.g = g;
+    sender.h = h;
+    sender.mpk = mpk;
+    sender.fileIDBytes = fileIDBytes;
+    sender.hLines = hLines;
+    sender.indexPoints = indexPoints; // h1 only depends on the file
+    sender.nodeIDBytes = std::vector<uint8_t>(nodeID.begin(), nodeID.end());
+    sender.big_r = nodeKey;
+    sender.keyLines = PrecomputedG2(nodeKey + (mpk * h0(sender.nodeIDBytes, nodeKey)));
+    return sender;
+}
+
+G2 Li::NodeKey() { return big_r; }
+
+size_t Li::MemoryFootprint()
+{
+    return sizeof(Li) + nodeIDBytes.size() + fileIDBytes.size() +
+           keyLines.lines.size() * sizeof(Fp6) + positionScalars.Size() * sizeof(Fr);
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+#include <mapped_file.hpp>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(int fd, size_t size, bool writable)
+{
+    this->fd = fd;
+    this->size = size;
+    this->data = nullptr;
+    if (size == 0)
+    {
+        return;
+    }
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void *p = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not map file!");
+    }
+    data = (uint8_t *)p;
+    if (!writable)
+    {
+        // pieces are read front to back
+        madvise(p, size, MADV_SEQUENTIAL);
+    }
+}
+
+MappedFile MappedFile::OpenRead(const std::string &path)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not open " + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not stat " + path);
+    }
+    return MappedFile(fd, st.st_size, false);
+}
+
+MappedFile MappedFile::Create(const std::string &path, size_t size)
+{
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+    {
+        throw std::runtime_error("Could not create " + path);
+    }
+    if (ftruncate(fd, size) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not resize " + path);
+    }
+    return MappedFile(fd, size, true);
+}
+
+MappedFile::MappedFile()
+{
+    fd = -1;
+    data = nullptr;
+    size = 0;
+}
+
+MappedFile::MappedFile(MappedFile &&other)
+{
+    fd = other.fd;
+    data = other.data;
+    size = other.size;
+    other.fd = -1;
+    other.data = nullptr;
+    other.size = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other)
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(fd, other.fd);
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() { Close(); }
+
+uint8_t *MappedFile::Data() { return data; }
+
+size_t MappedFile::Size() { return size; }
+
+void MappedFile::Sync()
+{
+    if (data && msync(data, size, MS_SYNC) != 0)
+    {
+        throw std::runtime_error("Could not sync mapped file!");
+    }
+}
+
+void MappedFile::Close()
+{
+    if (data)
+    {
+        munmap(data, size);
+        data = nullptr;
+    }
+    if (fd >= 0)
+    {
+        ::close(fd);
+        fd = -1;
+    }
+    size = 0;
+}
@@ -2,6 +2,7 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <stdexcept>
+#include <algorithm>
 
 using namespace mcl::bls12;
 
@@ -9,16 +10,90 @@ Matrix::Matrix(int rows, int cols)
 {
     this->rows = rows;
     this->cols = cols;
-    this->data = std::vector<std::vector<Fr>>(rows, std::vector<Fr>(cols, 0));
+    this->storage.assign((size_t)rows * cols, 0);
+    this->order.resize(rows);
+    for (int i = 0; i < rows; i++)
+    {
+        order[i] = i;
+    }
+}
+
+Matrix::Matrix()
+{
+    rows = 0;
+    cols = 0;
+};
+
+Matrix::Matrix(std::vector<std::vector<Fr>> d) : Matrix(0, d.empty() ? 0 : d[0].size())
+{
+    for (int i = 0; i < d.size(); i++)
+    {
+        AppendRow(d[i]);
+    }
 }
 
-Matrix::Matrix(){};
+Fr *Matrix::Row(int i) { return storage.data() + (size_t)order[i] * cols; }
 
-Matrix::Matrix(std::vector<std::vector<Fr>> d)
+const Fr *Matrix::Row(int i) const { return storage.data() + (size_t)order[i] * cols; }
+
+Fr &Matrix::At(int i, int j) { return Row(i)[j]; }
+
+std::vector<Fr> Matrix::GetRow(int i) const
+{
+    const Fr *row = Row(i);
+    return std::vector<Fr>(row, row + cols);
+}
+
+void Matrix::AppendRow(Span<const Fr> row)
 {
-    this->data = d;
-    this->rows = d.size();
-    this->cols = d[0].size();
+    if (row.size() != cols)
+    {
+        throw std::runtime_error("Matrix dimensions do not match!");
+    }
+    int slot;
+    if (!freeRows.empty())
+    {
+        slot = freeRows.back();
+        freeRows.pop_back();
+        std::copy(row.begin(), row.end(), storage.begin() + (size_t)slot * cols);
+    }
+    else
+    {
+        slot = order.size();
+        storage.insert(storage.end(), row.begin(), row.end());
+    }
+    order.push_back(slot);
+    rows++;
+}
+
+void Matrix::SwapRows(int a, int b) { std::swap(order[a], order[b]); }
+
+void Matrix::RemoveRow(int i)
+{
+    freeRows.push_back(order[i]);
+    order.erase(order.begin() + i);
+    rows--;
+}
+
+void Matrix::SubtractRow(int dst, int src, const Fr &by, int from)
+{
+    Fr *d = Row(dst);
+    const Fr *s = Row(src);
+    Fr t;
+    for (int k = from; k < cols; k++)
+    {
+        Fr::mul(t, s[k], by);
+        Fr::sub(d[k], d[k], t);
+    }
+}
+
+void Matrix::ScaleRow(int i, const Fr &by, int from)
+{
+    Fr *row = Row(i);
+    for (int k = from; k < cols; k++)
+    {
+        Fr::mul(row[k], row[k], by);
+    }
 }
 
 bool Matrix::Cmp(Matrix &other)
@@ -31,7 +106,7 @@ bool Matrix::Cmp(Matrix &other)
     {
         for (int j = 0; j < this->cols; j++)
         {
-            if (this->data[i][j] != other.data[i][j])
+            if (this->At(i, j) != other.At(i, j))
             {
                 return false;
             }
@@ -49,14 +124,89 @@ Matrix Matrix::Multiply(Matrix other)
     Matrix ret(this->rows, other.cols);
     for (int i = 0; i < this->rows; i++)
     {
-        for (int j = 0; j < other.cols; j++)
+        Fr *out = ret.Row(i);
+        const Fr *row = this->Row(i);
+        for (int k = 0; k < this->cols; k++)
         {
-            ret.data[i][j] = 0;
-            for (int k = 0; k < this->cols; k++)
+            if (row[k].isZero())
             {
-                ret.data[i][j] += this->data[i][k] * other.data[k][j];
+                continue;
             }
+            const Fr *src = other.Row(k);
+            for (int j = 0; j < other.cols; j++)
+            {
+                out[j] += row[k] * src[j];
+            }
+        }
+    }
+    return ret;
+}
+
+SparseRow::SparseRow(Span<const Fr> dense)
+{
+    for (int i = 0; i < dense.size(); i++)
+    {
+        if (!dense[i].isZero())
+        {
+            cols.push_back(i);
+            values.push_back(dense[i]);
         }
     }
+}
+
+SparseRow::SparseRow(){};
+
+bool SparseRow::Empty() { return cols.empty(); }
+
+void SparseRow::Scale(const Fr &by)
+{
+    for (int i = 0; i < values.size(); i++)
+    {
+        values[i] *= by;
+    }
+}
+
+void SparseRow::SubtractMultiple(const SparseRow &other, const Fr &by)
+{
+    std::vector<int> mergedCols;
+    std::vector<Fr> mergedValues;
+    mergedCols.reserve(cols.size() + other.cols.size());
+    mergedValues.reserve(cols.size() + other.cols.size());
+    int i = 0, j = 0;
+    while (i < cols.size() || j < other.cols.size())
+    {
+        if (j == other.cols.size() || (i < cols.size() && cols[i] < other.cols[j]))
+        {
+            mergedCols.push_back(cols[i]);
+            mergedValues.push_back(values[i++]);
+            continue;
+        }
+        Fr x = other.values[j] * by;
+        if (i < cols.size() && cols[i] == other.cols[j])
+        {
+            x = values[i++] - x;
+        }
+        else
+        {
+            Fr::neg(x, x);
+        }
+        if (!x.isZero())
+        {
+            mergedCols.push_back(other.cols[j]);
+            mergedValues.push_back(x);
+        }
+        j++;
+    }
+    cols.swap(mergedCols);
+    values.swap(mergedValues);
+}
+
+std::vector<Fr> SparseRow::Dense(int n)
+{
+    std::vector<Fr> ret(n, 0);
+    for (int i = 0; i < cols.size(); i++)
+    {
+        ret[cols[i]] = values[i];
+    }
     return ret;
 }
\ No newline at end of file
@@ -0,0 +1,305 @@
+#include <msm.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <memory>
+#include <stdexcept>
+#include <functional>
+#include <algorithm>
+#include <thread_pool.hpp>
+#include <workspace.hpp>
+
+const int SCALAR_BITS = 255;
+const int MAX_WINDOW = 12;
+const int SHORT_SCALAR_BITS = 32;
+const int MAX_SHORT_WINDOW = 16;
+
+std::shared_ptr<ThreadPool> msmPool;
+int msmThreshold = 1024;
+
+void SetParallelMSM(std::shared_ptr<ThreadPool> pool, int threshold)
+{
+    msmPool = pool;
+    msmThreshold = threshold;
+}
+
+std::shared_ptr<ThreadPool> parallelPool(int n)
+{
+    if (n < msmThreshold)
+    {
+        return nullptr;
+    }
+    std::shared_ptr<ThreadPool> pool = msmPool ? msmPool : ThreadPool::Shared();
+    if (pool->Size() == 0)
+    {
+        return nullptr;
+    }
+    return pool;
+}
+
+// Splits [0, n) into one range per thread (the caller counts as one), runs
+// task on each range and adds up the partial results.
+void sumRanges(G1 &out, std::shared_ptr<ThreadPool> pool, int n, const std::function<void(G1 &, int, int)> &task)
+{
+    int chunks = std::min(pool->Size() + 1, n);
+    std::vector<G1> partial(chunks);
+    pool->ParallelFor(chunks, [&](int c)
+                      { task(partial[c], (long)n * c / chunks, (long)n * (c + 1) / chunks); });
+    out = partial[0];
+    for (int c = 1; c < chunks; c++)
+    {
+        out += partial[c];
+    }
+}
+
+// Returns the bit length of the largest scalar and their values, or 0 when
+// some scalar is wider than SHORT_SCALAR_BITS.
+int shortScalars(const Fr *scalars, int n, std::vector<uint32_t> &values)
+{
+    uint8_t bytes[32];
+    uint32_t all = 0;
+    values.resize(n);
+    for (int i = 0; i < n; i++)
+    {
+        scalars[i].serialize(bytes, sizeof(bytes)); // little endian
+        for (int b = 4; b < sizeof(bytes); b++)
+        {
+            if (bytes[b] != 0)
+            {
+                return 0;
+            }
+        }
+        values[i] = bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+        all |= values[i];
+    }
+    int bits = 0;
+    while (bits < SHORT_SCALAR_BITS && (all >> bits) != 0)
+    {
+        bits++;
+    }
+    return bits;
+}
+
+// Bucket method for scalars below 2^bits: only bits doublings in total,
+// however large n is.
+void shortMulVec(G1 &out, const G1 *points, const uint32_t *values, int n, int bits)
+{
+    int window = 1;
+    double bestCost = 0;
+    for (int c = 1; c <= std::min(bits, MAX_SHORT_WINDOW); c++)
+    {
+        double cost = (double)((bits + c - 1) / c) * (n + 2.0 * (1 << c));
+        if (c == 1 || cost < bestCost)
+        {
+            window = c;
+            bestCost = cost;
+        }
+    }
+    std::vector<G1> &buckets = LocalWorkspace().buckets;
+    buckets.resize(1 << window);
+    out.clear();
+    for (int bit = ((bits - 1) / window) * window; bit >= 0; bit -= window)
+    {
+        for (int b = 0; b < window && !out.isZero(); b++)
+        {
+            G1::dbl(out, out);
+        }
+        for (int d = 0; d < buckets.size(); d++)
+        {
+            buckets[d].clear();
+        }
+        for (int i = 0; i < n; i++)
+        {
+            int digit = (values[i] >> bit) & ((1 << window) - 1);
+            if (digit != 0)
+            {
+                G1::add(buckets[digit], buckets[digit], points[i]);
+            }
+        }
+        G1 running;
+        running.clear();
+        for (int d = buckets.size() - 1; d > 0; d--)
+        {
+            G1::add(running, running, buckets[d]);
+            G1::add(out, out, running);
+        }
+    }
+}
+
+void MultiExp(G1 &out, G1 *points, const Fr *scalars, int n)
+{
+    if (n == 0)
+    {
+        out.clear();
+        return;
+    }
+    std::shared_ptr<ThreadPool> pool = parallelPool(n);
+    // coefficients of the short coding mode
+    std::vector<uint32_t> &values = LocalWorkspace().shortScalars;
+    int bits = shortScalars(scalars, n, values);
+    if (bits > 0)
+    {
+        if (!pool)
+        {
+            shortMulVec(out, points, values.data(), n, bits);
+            return;
+        }
+        sumRanges(out, pool, n, [&](G1 &part, int begin, int end)
+                  { shortMulVec(part, points + begin, values.data() + begin, end - begin, bits); });
+        return;
+    }
+    if (!pool)
+    {
+        G1::mulVec(out, points, scalars, n);
+        return;
+    }
+    sumRanges(out, pool, n, [&](G1 &part, int begin, int end)
+              { G1::mulVec(part, points + begin, scalars + begin, end - begin); });
+}
+
+void MSMTerms::Add(const G1 &P, const Fr &x)
+{
+    if (x.isZero())
+    {
+        return;
+    }
+    points.push_back(P);
+    scalars.push_back(x);
+}
+
+void MSMTerms::AddNonZero(const G1 *P, const Fr *x, int n)
+{
+    for (int i = 0; i < n; i++)
+    {
+        Add(P[i], x[i]);
+    }
+}
+
+void MSMTerms::Clear()
+{
+    points.clear();
+    scalars.clear();
+}
+
+void MSMTerms::Eval(G1 &out) { MultiExp(out, points.data(), scalars.data(), points.size()); }
+
+FixedBaseMSM::FixedBaseMSM(std::vector<G1> &points, size_t memoryBudget)
+{
+    bases = points.size();
+    window = 0;
+    windows = 0;
+    double bestCost = 0;
+    for (int c = 2; c <= MAX_WINDOW; c++)
+    {
+        int m = (SCALAR_BITS + c - 1) / c;
+        if ((size_t)bases * m * sizeof(G1) > memoryBudget)
+        {
+            continue;
+        }
+        // one addition per base and window, plus collecting 2^c buckets
+        double cost = (double)bases * m + 2.0 * (1 << c);
+        if (window == 0 || cost < bestCost)
+        {
+            window = c;
+            windows = m;
+            bestCost = cost;
+        }
+    }
+    if (window == 0 || bases == 0)
+    {
+        window = 0;
+        return;
+    }
+
+    std::shared_ptr<std::vector<G1>> t = std::make_shared<std::vector<G1>>(bases * windows);
+    for (int i = 0; i < bases; i++)
+    {
+        G1 P = points[i];
+        for (int j = 0; j < windows; j++)
+        {
+            P.normalize();
+            (*t)[i * windows + j] = P;
+            for (int b = 0; b < window; b++)
+            {
+                G1::dbl(P, P);
+            }
+        }
+    }
+    table = t;
+}
+
+FixedBaseMSM::FixedBaseMSM()
+{
+    window = 0;
+    windows = 0;
+    bases = 0;
+}
+
+bool FixedBaseMSM::Enabled() { return window > 0; }
+
+size_t FixedBaseMSM::MemoryFootprint()
+{
+    if (!table)
+    {
+        return 0;
+    }
+    return table->size() * sizeof(G1);
+}
+
+void FixedBaseMSM::MulVec(G1 &out, const Fr *scalars, int n)
+{
+    if (n > bases)
+    {
+        throw std::out_of_range("More scalars than precomputed bases!");
+    }
+    std::shared_ptr<ThreadPool> pool = parallelPool(n);
+    if (!pool)
+    {
+        mulRange(out, scalars, 0, n);
+        return;
+    }
+    sumRanges(out, pool, n, [&](G1 &part, int begin, int end)
+              { mulRange(part, scalars, begin, end); });
+}
+
+void FixedBaseMSM::mulRange(G1 &out, const Fr *scalars, int begin, int end)
+{
+    std::vector<G1> &buckets = LocalWorkspace().buckets;
+    buckets.resize(1 << window);
+    for (int d = 0; d < buckets.size(); d++)
+    {
+        buckets[d].clear();
+    }
+
+    uint8_t bytes[32];
+    for (int i = begin; i < end; i++)
+    {
+        if (scalars[i].isZero())
+        {
+            continue;
+        }
+        scalars[i].serialize(bytes, sizeof(bytes)); // little endian
+        for (int j = 0; j < windows; j++)
+        {
+            int bit = j * window;
+            int digit = 0;
+            for (int b = 0; b < window && bit + b < 256; b++)
+            {
+                digit |= ((bytes[(bit + b) >> 3] >> ((bit + b) & 7)) & 1) << b;
+            }
+            if (digit != 0)
+            {
+                G1::add(buckets[digit], buckets[digit], (*table)[i * windows + j]);
+            }
+        }
+    }
+
+    // sum_d d * buckets[d] as a running sum from the top
+    G1 running;
+    running.clear();
+    out.clear();
+    for (int d = buckets.size() - 1; d > 0; d--)
+    {
+        G1::add(running, running, buckets[d]);
+        G1::add(out, out, running);
+    }
+}
\ No newline at end of file
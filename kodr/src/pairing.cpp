@@ -0,0 +1,21 @@
+#include <pairing.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+
+PrecomputedG2::PrecomputedG2(const G2 &Q)
+{
+    point = Q;
+    precomputeG2(lines, point);
+}
+
+PrecomputedG2::PrecomputedG2(){};
+
+bool PairingsEqual(const G1 &P1, const PrecomputedG2 &Q1, const G1 &P2, const PrecomputedG2 &Q2)
+{
+    Fp12 e;
+    G1 negP2;
+    G1::neg(negP2, P2);
+    precomputedMillerLoop2(e, P1, Q1.lines, negP2, Q2.lines);
+    finalExp(e, e);
+    return e.isOne();
+}
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include <point_cache.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <algorithm>
+#include <atomic>
+
+template <typename T>
+IndexCache<T>::IndexCache()
+{
+    state = std::make_shared<State>();
+    state->values = std::make_shared<std::vector<T>>();
+    state->prefix = 0;
+}
+
+template <typename T>
+std::shared_ptr<const std::vector<T>> IndexCache<T>::Get(int n, const std::function<void(T &, int)> &derive)
+{
+    {
+        std::lock_guard<std::mutex> guard(state->lock);
+        if (state->prefix >= n)
+        {
+            return state->values;
+        }
+    }
+    std::vector<int> indices(n);
+    for (int i = 0; i < n; i++)
+    {
+        indices[i] = i;
+    }
+    return GetSome(indices, derive);
+}
+
+template <typename T>
+std::shared_ptr<const std::vector<T>> IndexCache<T>::GetSome(const std::vector<int> &indices, const std::function<void(T &, int)> &derive)
+{
+    std::lock_guard<std::mutex> guard(state->lock);
+    std::vector<int> missing;
+    int size = state->values->size();
+    for (int i = 0; i < indices.size(); i++)
+    {
+        if (indices[i] >= state->ready.size() || !state->ready[indices[i]])
+        {
+            missing.push_back(indices[i]);
+            size = std::max(size, indices[i] + 1);
+        }
+    }
+    if (missing.empty())
+    {
+        return state->values;
+    }
+
+    // no new reference can be taken without the lock, so when only the cache
+    // and grown hold the table no reader can see it change in place
+    std::shared_ptr<std::vector<T>> grown = state->values;
+    if (grown.use_count() > 2)
+    {
+        grown = std::make_shared<std::vector<T>>();
+        grown->reserve(std::max<size_t>(size, 2 * state->values->capacity()));
+        grown->assign(state->values->begin(), state->values->end());
+    }
+    else
+    {
+        // use_count is a relaxed load; order the reads of the readers that
+        // dropped their reference before the writes below
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (grown->capacity() < size)
+        {
+            grown->reserve(std::max<size_t>(size, 2 * grown->capacity()));
+        }
+    }
+    grown->resize(size);
+    state->ready.resize(size, false);
+    for (int i = 0; i < missing.size(); i++)
+    {
+        if (!state->ready[missing[i]])
+        {
+            derive((*grown)[missing[i]], missing[i]);
+            state->ready[missing[i]] = true;
+        }
+    }
+    while (state->prefix < size && state->ready[state->prefix])
+    {
+        state->prefix++;
+    }
+    state->values = grown;
+    return state->values;
+}
+
+template <typename T>
+void IndexCache<T>::Clear()
+{
+    std::lock_guard<std::mutex> guard(state->lock);
+    state->values = std::make_shared<std::vector<T>>();
+    state->ready.clear();
+    state->prefix = 0;
+}
+
+template <typename T>
+int IndexCache<T>::Size()
+{
+    std::lock_guard<std::mutex> guard(state->lock);
+    return state->values->size();
+}
+
+template class IndexCache<G1>;
+template class IndexCache<Fr>;
\ No newline at end of file
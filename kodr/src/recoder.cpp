@@ -2,6 +2,7 @@
 #include <matrix.hpp>
 #include <mcl/bls12_381.hpp>
 #include <vector>
+#include <stdexcept>
 #include <recoder.hpp>
 #include <boneh.hpp>
 #include <li.hpp>
@@ -12,9 +13,12 @@
 template <typename T, typename S>
 FullRLNCRecoder<T, S>::FullRLNCRecoder(std::vector<CodedPiece<S>> ps, T sig)
 {
-    this->pieces = ps;
-    this->sig = sig;
     this->pieceCount = ps.size();
+    this->pieces = std::move(ps);
+    this->sig = sig;
+    this->coefficientBits = 0;
+    this->density = 1;
+    this->skipRedundant = false;
 }
 
 template <typename T, typename S>
@@ -22,49 +26,171 @@ FullRLNCRecoder<T, S>::FullRLNCRecoder(T sig)
 {
     this->sig = sig;
     this->pieceCount = 0;
+    this->coefficientBits = 0;
+    this->density = 1;
+    this->skipRedundant = false;
 }
 
 template <typename T, typename S>
-FullRLNCRecoder<T, S>::FullRLNCRecoder(){};
+FullRLNCRecoder<T, S>::FullRLNCRecoder()
+{
+    this->coefficientBits = 0;
+    this->density = 1;
+    this->skipRedundant = false;
+};
 
 template <typename T, typename S>
-void FullRLNCRecoder<T, S>::addPiece(CodedPiece<S> piece)
+void FullRLNCRecoder<T, S>::addPiece(CodedPiece<S> &piece)
 {
-    if (!sig.Verify(piece))
+    if (!accept(piece))
     {
-        std::cout << "Piece not verified" << std::endl;
         return;
     }
     this->pieces.push_back(piece);
     this->pieceCount++;
 }
 
+template <typename T, typename S>
+void FullRLNCRecoder<T, S>::addPiece(CodedPiece<S> &&piece)
+{
+    if (!accept(piece))
+    {
+        return;
+    }
+    this->pieces.push_back(std::move(piece));
+    this->pieceCount++;
+}
+
+template <typename T, typename S>
+bool FullRLNCRecoder<T, S>::accept(CodedPiece<S> &piece)
+{
+    if (skipRedundant)
+    {
+        if (basis.pivots.empty())
+        {
+            basis = DecoderState<S>(piece.dataLen() - piece.pieceSize);
+        }
+        if (!basis.IsInnovative(piece.codingVector()))
+        {
+            return false;
+        }
+    }
+    if (!sig.Verify(piece))
+    {
+        std::cout << "Piece not verified" << std::endl;
+        return false;
+    }
+    if (skipRedundant)
+    {
+        basis.dense_add(piece.codingVector(), Span<const Fr>());
+    }
+    return true;
+}
+
 template <typename T, typename S>
 void FullRLNCRecoder<T, S>::clear()
 {
     this->pieces.clear();
     this->pieceCount = 0;
+    basis = DecoderState<S>();
 }
 
 template <typename T, typename S>
 CodedPiece<S> FullRLNCRecoder<T, S>::getCodedPiece()
 {
-    std::vector<Fr> coefficients = generateCodingVector(this->pieceCount);
-    int size = this->pieces[0].piece.size();
+    std::vector<Fr> coefficients;
+    std::vector<uint32_t> shortCoeffs;
+    if (coefficientBits > 0)
+    {
+        shortCoeffs = generateShortCoefficients(this->pieceCount, coefficientBits);
+        coefficients = shortToField(shortCoeffs);
+    }
+    else
+    {
+        coefficients = generateCodingVector(this->pieceCount);
+    }
+    if (density < 1)
+    {
+        std::vector<bool> kept(this->pieceCount, false);
+        std::vector<int> support = sparseSupport(this->pieceCount, density);
+        for (int i = 0; i < support.size(); i++)
+        {
+            kept[support[i]] = true;
+        }
+        for (int i = 0; i < this->pieceCount; i++)
+        {
+            if (!kept[i])
+            {
+                coefficients[i] = 0;
+            }
+        }
+    }
+    int size = this->pieces[0].pieceSize;
     std::vector<Fr> pc(this->pieces[0].dataLen(), 0);
     std::vector<S> sigs(this->pieceCount);
 
     for (int i = 0; i < this->pieceCount; i++)
     {
         sigs[i] = this->pieces[i].signature;
-        pc = multiply(pc, this->pieces[i].flatten(), coefficients[i]);
+        if (coefficients[i].isZero())
+        {
+            continue;
+        }
+        if (coefficientBits > 0)
+        {
+            multiplyAddShort(pc, this->pieces[i].buffer, shortCoeffs[i]);
+        }
+        else
+        {
+            multiplyAdd(pc, this->pieces[i].buffer, coefficients[i]);
+        }
     }
 
     S signature = sig.Combine(sigs, coefficients);
 
-    std::vector<Fr> recodedPiece(pc.begin(), pc.begin() + size);
-    std::vector<Fr> recodedVec(pc.begin() + size, pc.end());
-    return CodedPiece<S>(recodedPiece, recodedVec, signature);
+    return CodedPiece<S>(std::move(pc), size, signature);
+}
+
+template <typename T, typename S>
+void FullRLNCRecoder<T, S>::setShortCoefficients(int bits)
+{
+    if (bits < 0 || bits > 32)
+    {
+        throw std::invalid_argument("Short coefficients must have 1 to 32 bits!");
+    }
+    this->coefficientBits = bits;
+}
+
+template <typename T, typename S>
+void FullRLNCRecoder<T, S>::setDensity(double density)
+{
+    if (density <= 0 || density > 1)
+    {
+        throw std::invalid_argument("Density must be in (0, 1]!");
+    }
+    this->density = density;
+}
+
+template <typename T, typename S>
+void FullRLNCRecoder<T, S>::setSkipRedundant(bool skip)
+{
+    this->skipRedundant = skip;
+    basis = DecoderState<S>();
+    if (!skip || pieces.empty())
+    {
+        return;
+    }
+    basis = DecoderState<S>(pieces[0].dataLen() - pieces[0].pieceSize);
+    for (int i = 0; i < pieces.size(); i++)
+    {
+        basis.dense_add(pieces[i].codingVector(), Span<const Fr>());
+    }
+}
+
+template <typename T, typename S>
+double FullRLNCRecoder<T, S>::NonInnovativeProbability()
+{
+    return (1 - density) + density * ::NonInnovativeProbability(coefficientBits);
 }
 
 template class FullRLNCRecoder<Boneh, G1>;
@@ -0,0 +1,153 @@
+#include <stream.hpp>
+#include <data.hpp>
+#include <encoder.hpp>
+#include <decoder.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <stdexcept>
+#include <algorithm>
+#include <boneh.hpp>
+#include <li.hpp>
+#include <zhang.hpp>
+#include <catalano.hpp>
+#include <chang.hpp>
+
+StreamLayout::StreamLayout(uint64_t totalLength, int generationBytes, int pieceCount, bool packed)
+{
+    if (generationBytes <= 0 || pieceCount <= 0)
+    {
+        throw std::invalid_argument("Generations need a positive size and piece count!");
+    }
+    this->totalLength = totalLength;
+    this->generationBytes = generationBytes;
+    this->pieceCount = pieceCount;
+    this->packed = packed;
+}
+
+StreamLayout::StreamLayout()
+{
+    totalLength = 0;
+    generationBytes = 0;
+    pieceCount = 0;
+    packed = false;
+}
+
+uint32_t StreamLayout::Generations()
+{
+    return (totalLength + generationBytes - 1) / generationBytes;
+}
+
+int StreamLayout::GenerationLength(uint32_t generation)
+{
+    uint64_t begin = (uint64_t)generation * generationBytes;
+    if (begin >= totalLength)
+    {
+        throw std::out_of_range("Generation past the end of the stream!");
+    }
+    return std::min<uint64_t>(generationBytes, totalLength - begin);
+}
+
+int StreamLayout::PieceSize() { return PieceSizeFor(generationBytes, pieceCount, packed); }
+
+template <typename T, typename S>
+StreamEncoder<T, S>::StreamEncoder(std::istream &in, StreamLayout layout, std::function<T(uint32_t)> schemeFor, bool generateSystematic)
+{
+    this->in = &in;
+    this->layout = layout;
+    this->schemeFor = schemeFor;
+    this->generation = 0;
+    this->started = false;
+    this->encoder.useSystematic = generateSystematic;
+}
+
+template <typename T, typename S>
+bool StreamEncoder<T, S>::NextGeneration()
+{
+    uint32_t g = started ? generation + 1 : 0;
+    if (g >= layout.Generations())
+    {
+        return false;
+    }
+    std::vector<uint8_t> data(layout.GenerationLength(g));
+    in->read((char *)data.data(), data.size());
+    if (in->gcount() != data.size())
+    {
+        throw std::runtime_error("Stream ended before its announced length!");
+    }
+    generation = g;
+    started = true;
+    encoder.sig = schemeFor(g);
+    encoder.setPieces(OriginalPiecesWithCountAndSize(data, layout.pieceCount, layout.PieceSize(), layout.packed));
+    return true;
+}
+
+template <typename T, typename S>
+uint32_t StreamEncoder<T, S>::Generation() { return generation; }
+
+template <typename T, typename S>
+CodedPiece<S> StreamEncoder<T, S>::getCodedPiece()
+{
+    if (!started)
+    {
+        throw std::runtime_error("No generation loaded!");
+    }
+    return encoder.getCodedPiece();
+}
+
+template <typename T, typename S>
+StreamDecoder<T, S>::StreamDecoder(std::ostream &out, StreamLayout layout, std::function<T(uint32_t)> schemeFor, uint32_t window, bool sparse)
+{
+    this->out = &out;
+    this->layout = layout;
+    this->schemeFor = schemeFor;
+    this->next = 0;
+    this->window = std::max<uint32_t>(window, 1);
+    this->sparse = sparse;
+}
+
+template <typename T, typename S>
+bool StreamDecoder<T, S>::addPiece(uint32_t generation, CodedPiece<S> &piece)
+{
+    if (generation < next || generation >= next + window || generation >= layout.Generations())
+    {
+        return false;
+    }
+    auto it = pending.find(generation);
+    if (it == pending.end())
+    {
+        it = pending.emplace(generation, FullRLNCDecoder<T, S>(layout.pieceCount, schemeFor(generation), layout.packed, sparse)).first;
+    }
+    it->second.addPiece(piece);
+    flush();
+    return true;
+}
+
+template <typename T, typename S>
+void StreamDecoder<T, S>::flush()
+{
+    for (auto it = pending.find(next); it != pending.end() && it->second.IsDecoded(); it = pending.find(next))
+    {
+        std::vector<uint8_t> data = it->second.getData(layout.GenerationLength(next));
+        out->write((const char *)data.data(), data.size());
+        pending.erase(it);
+        next++;
+    }
+}
+
+template <typename T, typename S>
+uint32_t StreamDecoder<T, S>::Written() { return next; }
+
+template <typename T, typename S>
+bool StreamDecoder<T, S>::IsDecoded() { return next >= layout.Generations(); }
+
+template class StreamEncoder<Boneh, G1>;
+template class StreamEncoder<Li, G1>;
+template class StreamEncoder<Zhang, G1>;
+template class StreamEncoder<Catalano, CatSignature>;
+template class StreamEncoder<Chang, G1>;
+
+template class StreamDecoder<Boneh, G1>;
+template class StreamDecoder<Li, G1>;
+template class StreamDecoder<Zhang, G1>;
+template class StreamDecoder<Catalano, CatSignature>;
+template class StreamDecoder<Chang, G1>;
@@ -0,0 +1,114 @@
+#include <thread_pool.hpp>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads)
+{
+    stopping = false;
+    for (int i = 0; i < threads; i++)
+    {
+        workers.push_back(std::thread(&ThreadPool::run, this));
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (int i = 0; i < workers.size(); i++)
+    {
+        workers[i].join();
+    }
+}
+
+void ThreadPool::run()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            wake.wait(guard, [this]
+                      { return stopping || !tasks.empty(); });
+            if (tasks.empty())
+            {
+                return;
+            }
+            task = tasks.front();
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+int ThreadPool::Size() { return workers.size(); }
+
+void ThreadPool::Submit(std::function<void()> task)
+{
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        tasks.push_back(task);
+    }
+    wake.notify_one();
+}
+
+struct ParallelForState
+{
+    std::function<void(int)> task;
+    int n;
+    std::atomic<int> next;
+    std::atomic<int> done;
+    std::mutex lock;
+    std::condition_variable finished;
+
+    // claims indices until none are left
+    void work()
+    {
+        for (int i = next++; i < n; i = next++)
+        {
+            task(i);
+            if (++done == n)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                finished.notify_all();
+            }
+        }
+    }
+};
+
+void ThreadPool::ParallelFor(int n, const std::function<void(int)> &task)
+{
+    if (n <= 0)
+    {
+        return;
+    }
+    std::shared_ptr<ParallelForState> state = std::make_shared<ParallelForState>();
+    state->task = task;
+    state->n = n;
+    state->next = 0;
+    state->done = 0;
+    int helpers = std::min(n - 1, Size());
+    for (int i = 0; i < helpers; i++)
+    {
+        Submit([state]
+               { state->work(); });
+    }
+    state->work();
+    std::unique_lock<std::mutex> guard(state->lock);
+    state->finished.wait(guard, [state]
+                         { return state->done == state->n; });
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::Shared()
+{
+    static std::shared_ptr<ThreadPool> pool = std::make_shared<ThreadPool>(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
\ No newline at end of file
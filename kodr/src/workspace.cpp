@@ -0,0 +1,23 @@
+#include <workspace.hpp>
+#include <mcl/bls12_381.hpp>
+#include <vector>
+#include <stdexcept>
+
+const int G2_BYTES = 96;
+
+Workspace &LocalWorkspace()
+{
+    thread_local Workspace workspace;
+    return workspace;
+}
+
+void appendPoint(std::vector<uint8_t> &buf, const G2 &P)
+{
+    uint8_t bytes[G2_BYTES];
+    size_t n = P.serialize(bytes, sizeof(bytes), mcl::IoSerialize);
+    if (n == 0)
+    {
+        throw std::runtime_error("Could not serialize point!");
+    }
+    buf.insert(buf.end(), bytes, bytes + n);
+}
@@ -1,8 +1,12 @@
 #include <mcl/bls12_381.hpp>
 #include <vector>
 #include <zhang.hpp>
+#include <batch.hpp>
+#include <workspace.hpp>
+#include <msm.hpp>
 #include <random>
 #include <assert.h>
+#include <stdexcept>
 
 Zhang::Zhang(std::string nodeID, std::string fileName)
 {
@@ -15,7 +19,10 @@ Zhang::Zhang(std::string nodeID, std::string fileName)
     Fr r;
     r.setRand();
     hr = h * r;
-    y = r + msk * h0(hr, nodeIDBytes);
+    Fr idDigest = h0(hr, nodeIDBytes);
+    y = r + msk * idDigest;
+    hLines = PrecomputedG2(h);
+    keyLines = PrecomputedG2(hr + (hz * idDigest));
 }
 
 Zhang::Zhang(){};
@@ -23,59 +30,103 @@ Zhang::Zhang(){};
 Fr Zhang::h0(G2 &element, std::vector<uint8_t> &extraBytes)
 {
     Fr result;
-    std::string tempString = element.getStr(mcl::IoSerialize);
-    std::vector<uint8_t> inputBytes(tempString.begin(), tempString.end());
-    std::vector<uint8_t> combined(inputBytes.size() + extraBytes.size());
-    std::copy(inputBytes.begin(), inputBytes.end(), combined.begin());
-    std::copy(extraBytes.begin(), extraBytes.end(), combined.begin() + inputBytes.size());
-    result.setHashOf(combined.data(), combined.size());
+    std::vector<uint8_t> &buf = LocalWorkspace().hashInput;
+    buf.clear();
+    appendPoint(buf, element);
+    buf.insert(buf.end(), extraBytes.begin(), extraBytes.end());
+    result.setHashOf(buf.data(), buf.size());
     return result;
 }
 
 G1 Zhang::h1(std::vector<uint8_t> &inputBytes, uint8_t &index)
 {
     G1 result;
-    std::vector<uint8_t> inputBytesWithExtra(inputBytes.size() + 1);
-    std::copy(inputBytes.begin(), inputBytes.end(), inputBytesWithExtra.begin());
-    inputBytesWithExtra[inputBytes.size()] = index;
-    hashAndMapToG1(result, inputBytesWithExtra.data(), inputBytesWithExtra.size());
+    std::vector<uint8_t> &buf = LocalWorkspace().hashInput;
+    buf.assign(inputBytes.begin(), inputBytes.end());
+    buf.push_back(index);
+    hashAndMapToG1(result, buf.data(), buf.size());
     return result;
 }
 
-G1 Zhang::AggregateHash(std::vector<Fr> &vec, std::vector<Fr> &codingVec) {
+G1 Zhang::AggregateHash(Span<const Fr> vec, Span<const Fr> codingVec) {
     G1 sig;
-    mapToG1(sig, 1);
-    std::vector<Fr> fullVector(vec.size() + codingVec.size());
-    std::copy(vec.begin(), vec.end(), fullVector.begin());
-    std::copy(codingVec.begin(), codingVec.end(), fullVector.begin() + vec.size());
-    std::vector<G1> hashes(fullVector.size());
-    for (uint8_t i = 0; i < fullVector.size(); i++) {
-        hashes[i] = h1(fileIDBytes, i);
+    // only the points of nonzero entries of vec || codingVec are hashed and
+    // multiplied
+    Workspace &ws = LocalWorkspace();
+    std::vector<int> &indices = ws.indices;
+    indices.clear();
+    appendNonZeroIndices(indices, vec);
+    appendNonZeroIndices(indices, codingVec, vec.size());
+    std::shared_ptr<const std::vector<G1>> hashes = indexPoints.GetSome(indices, [this](G1 &P, int i)
+                                                                        { uint8_t index = i; P = h1(fileIDBytes, index); });
+    MSMTerms &terms = ws.terms;
+    terms.Clear();
+    for (int i = 0; i < indices.size(); i++)
+    {
+        int j = indices[i];
+        terms.Add((*hashes)[j], j < vec.size() ? vec[j] : codingVec[j - vec.size()]);
     }
-    G1::mulVec(sig, hashes.data(), fullVector.data(), fullVector.size());
+    terms.Eval(sig);
     return sig;
 }
 
-G1 Zhang::Sign(std::vector<Fr> &vec, std::vector<Fr> &codingVec) {
+G1 Zhang::Sign(Span<const Fr> vec, Span<const Fr> codingVec) {
     G1 sig = AggregateHash(vec, codingVec);
     sig *= y;
     return sig;
 }
 
-G1 Zhang::Combine(std::vector<G1> &signs, std::vector<Fr> &coeffs)
+G1 Zhang::Combine(std::vector<G1> &signs, Span<const Fr> coeffs)
 {
     G1 sig;
-    G1::mulVec(sig, signs.data(), coeffs.data(), signs.size());
+    MultiExp(sig, signs.data(), coeffs.data(), signs.size());
     return sig;
 }
 
 bool Zhang::Verify(CodedPiece<G1> &encodedPiece)
 {
-   Fp12 e1, e2;
-   pairing(e1, encodedPiece.signature, h);
-   Fr hzExp = h0(hr, nodeIDBytes);
-   G2 part2 = hr + (hz * hzExp);
-   G1 hashed = AggregateHash(encodedPiece.piece, encodedPiece.codingVector);
-   pairing(e2, hashed, part2);
-   return e1 == e2;
+   G1 hashed = AggregateHash(encodedPiece.piece(), encodedPiece.codingVector());
+   return PairingsEqual(encodedPiece.signature, hLines, hashed, keyLines);
 }
+
+std::vector<bool> Zhang::VerifyBatch(std::vector<CodedPiece<G1>> &encodedPieces)
+{
+    return BatchVerify(*this, encodedPieces);
+}
+
+Zhang Zhang::Extract(std::string nodeID)
+{
+    if (msk.isZero())
+    {
+        throw std::runtime_error("Only the master key holder can extract keys!");
+    }
+    // built from the public parameters, so the master secret stays here
+    Fr r;
+    r.setRand();
+    Zhang node = ForSender(nodeID, h * r);
+    node.y = r + msk * h0(node.hr, node.nodeIDBytes);
+    return node;
+}
+
+Zhang Zhang::ForSender(std::string nodeID, G2 nodeKey)
+{
+    Zhang sender;
+    sender.msk.clear();
+    sender.y.clear();
+    sender.h = h;
+    sender.hz = hz;
+    sender.fileIDBytes = fileIDBytes;
+    sender.hLines = hLines;
+    sender.indexPoints = indexPoints; // h1 only depends on the file
+    sender.nodeIDBytes = std::vector<uint8_t>(nodeID.begin(), nodeID.end());
+    sender.hr = nodeKey;
+    sender.keyLines = PrecomputedG2(nodeKey + (hz * h0(nodeKey, sender.nodeIDBytes)));
+    return sender;
+}
+
+G2 Zhang::NodeKey() { return hr; }
+
+size_t Zhang::MemoryFootprint()
+{
+    return sizeof(Zhang) + nodeIDBytes.size() + fileIDBytes.size() + keyLines.lines.size() * sizeof(Fp6);
+}
\ No newline at end of file